@@ -0,0 +1,314 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#include "hyx_conflict.h"
+#include "hyx_parallel.h"
+
+#include <algorithm> //sort, max, min
+#include <climits> //INT32_MIN, INT32_MAX
+#include <tuple> //tie
+#include <utility> //move
+
+namespace
+{
+    struct Meeting
+    {
+        hyx::Schedule schedule;
+        bool lab;
+    };
+
+    // the lecture, then the lab if the course has one; returns how many were written.
+    std::size_t meetings(const hyx::Course& course, Meeting (&out)[2])
+    {
+        out[0] = { course.get_schedule(), false };
+
+        if (const hyx::CourseWLAB* lab = dynamic_cast<const hyx::CourseWLAB*>(&course))
+        {
+            out[1] = { lab->get_lab_schedule(), true };
+
+            return 2;
+        }
+
+        return 1;
+    }
+
+    // the days a meeting runs, open ended where a date is missing; false if it has no usable time or runs backwards.
+    bool usable(const hyx::Schedule& schedule, std::int32_t& first_day, std::int32_t& last_day) noexcept
+    {
+        first_day = schedule.start_day;
+        last_day = (schedule.end_day == hyx::Schedule::no_date) ? INT32_MAX : schedule.end_day;
+
+        return schedule.start_minute != hyx::Schedule::no_time && schedule.end_minute != hyx::Schedule::no_time
+            && schedule.start_minute < schedule.end_minute && first_day <= last_day;
+    }
+
+    // whether [first, last] and [other_first, other_last] share a day that falls on weekday.
+    bool share_weekday(std::int32_t first, std::int32_t last, std::int32_t other_first, std::int32_t other_last, int weekday) noexcept
+    {
+        return hyx::schedule::has_weekday(std::max(first, other_first), std::min(last, other_last), weekday);
+    }
+
+    // one conflict per pair of meetings, with the weekdays of every report of that pair combined.
+    void merge(std::vector<hyx::Conflict>& conflicts)
+    {
+        auto key = [](const hyx::Conflict& conflict) {
+            return std::tie(conflict.first, conflict.first_lab, conflict.second, conflict.second_lab);
+        };
+
+        std::sort(conflicts.begin(), conflicts.end(), [&](const hyx::Conflict& lhs, const hyx::Conflict& rhs) { return key(lhs) < key(rhs); });
+
+        std::size_t kept = 0;
+
+        for (std::size_t i = 0; i < conflicts.size(); ++i)
+        {
+            if (kept != 0 && key(conflicts[kept - 1]) == key(conflicts[i]))
+            {
+                conflicts[kept - 1].week_days |= conflicts[i].week_days;
+            }
+            else
+            {
+                conflicts[kept++] = conflicts[i];
+            }
+        }
+
+        conflicts.resize(kept);
+    }
+}
+
+hyx::Conflict_index::Conflict_index(std::vector<const Course*> courses) :
+    courses_(std::move(courses)),
+    days_(),
+    levels_()
+{
+    for (std::uint32_t c = 0; c < this->courses_.size(); ++c)
+    {
+        Meeting found[2];
+        std::size_t count = meetings(*this->courses_[c], found);
+
+        for (std::size_t m = 0; m < count; ++m)
+        {
+            const Schedule& schedule = found[m].schedule;
+            std::int32_t first_day = 0;
+            std::int32_t last_day = 0;
+
+            if (not usable(schedule, first_day, last_day))
+            {
+                continue;
+            }
+
+            for (int weekday = 0; weekday < 7; ++weekday)
+            {
+                if (schedule.meets_on(weekday))
+                {
+                    this->days_[weekday].push_back({ first_day, last_day, schedule.start_minute, schedule.end_minute, schedule.end_minute, found[m].lab, c });
+                }
+            }
+        }
+    }
+
+    for (int weekday = 0; weekday < 7; ++weekday)
+    {
+        std::vector<Interval>& day = this->days_[weekday];
+        std::size_t size = day.size();
+
+        std::sort(day.begin(), day.end(), [](const Interval& lhs, const Interval& rhs) {
+            return lhs.start < rhs.start || (lhs.start == rhs.start && lhs.end < rhs.end);
+            });
+
+        // nodes of level k sit at the indices whose lowest k bits are set; their children are 2^(k-1) to either side.
+        // leaves come first, then each level takes the latest end of itself and both children.
+        std::size_t last_index = 0;
+        std::uint16_t last_end = 0;
+
+        for (std::size_t i = 0; i < size; i += 2)
+        {
+            last_index = i;
+            last_end = day[i].max_end = day[i].end;
+        }
+
+        int level = 1;
+
+        for (; (std::size_t{ 1 } << level) <= size; ++level)
+        {
+            std::size_t half = std::size_t{ 1 } << (level - 1);
+
+            for (std::size_t i = (half << 1) - 1; i < size; i += half << 2)
+            {
+                // a right child past the end stands for the last subtree that is there.
+                std::uint16_t right = (i + half < size) ? day[i + half].max_end : last_end;
+
+                day[i].max_end = std::max({ day[i].end, day[i - half].max_end, right });
+            }
+
+            last_index = ((last_index >> level) & 1) ? last_index : last_index + half;
+
+            if (last_index < size && day[last_index].max_end > last_end)
+            {
+                last_end = day[last_index].max_end;
+            }
+        }
+
+        this->levels_[weekday] = level - 1;
+    }
+}
+
+template <class Found>
+void hyx::Conflict_index::find(int weekday, std::uint16_t start, std::uint16_t end, Found&& found) const
+{
+    const std::vector<Interval>& day = this->days_[weekday];
+    std::size_t size = day.size();
+
+    struct Node
+    {
+        std::size_t index;
+        int level;
+        bool left_done;
+    };
+
+    if (size == 0)
+    {
+        return;
+    }
+
+    // top down from the root, so intervals are found in order of their start.
+    Node stack[64];
+    int top = 0;
+
+    stack[top++] = { (std::size_t{ 1 } << this->levels_[weekday]) - 1, this->levels_[weekday], false };
+
+    while (top != 0)
+    {
+        Node node = stack[--top];
+
+        if (node.level <= 3)
+        {
+            // small subtrees are cheaper to scan than to walk.
+            std::size_t first = node.index >> node.level << node.level;
+            std::size_t last = std::min(size, first + (std::size_t{ 1 } << (node.level + 1)) - 1);
+
+            for (std::size_t i = first; i < last && day[i].start < end; ++i)
+            {
+                if (start < day[i].end)
+                {
+                    found(day[i]);
+                }
+            }
+        }
+        else if (not node.left_done)
+        {
+            std::size_t left = node.index - (std::size_t{ 1 } << (node.level - 1));
+
+            stack[top++] = { node.index, node.level, true };
+
+            // the left subtree only matters if something in it ends after start.
+            if (left >= size || day[left].max_end > start)
+            {
+                stack[top++] = { left, node.level - 1, false };
+            }
+        }
+        else if (node.index < size && day[node.index].start < end)
+        {
+            if (start < day[node.index].end)
+            {
+                found(day[node.index]);
+            }
+
+            stack[top++] = { node.index + (std::size_t{ 1 } << (node.level - 1)), node.level - 1, false };
+        }
+    }
+}
+
+std::size_t hyx::Conflict_index::size() const noexcept
+{
+    return this->courses_.size();
+}
+
+std::vector<hyx::Conflict> hyx::Conflict_index::check(const Course& course) const
+{
+    return this->check(std::vector<const Course*>{ &course });
+}
+
+std::vector<hyx::Conflict> hyx::Conflict_index::check(const std::vector<const Course*>& proposed) const
+{
+    std::vector<Conflict> conflicts;
+
+    for (std::uint32_t p = 0; p < proposed.size(); ++p)
+    {
+        Meeting found[2];
+        std::size_t count = meetings(*proposed[p], found);
+
+        for (std::size_t m = 0; m < count; ++m)
+        {
+            const Schedule& schedule = found[m].schedule;
+            std::int32_t first_day = 0;
+            std::int32_t last_day = 0;
+
+            if (not usable(schedule, first_day, last_day))
+            {
+                continue;
+            }
+
+            for (int weekday = 0; weekday < 7; ++weekday)
+            {
+                if (not schedule.meets_on(weekday))
+                {
+                    continue;
+                }
+
+                this->find(weekday, schedule.start_minute, schedule.end_minute, [&](const Interval& interval) {
+                    if (this->courses_[interval.course] != proposed[p]
+                        && share_weekday(first_day, last_day, interval.first_day, interval.last_day, weekday))
+                    {
+                        conflicts.push_back({ p, found[m].lab, interval.course, interval.lab, static_cast<std::uint8_t>(1 << weekday) });
+                    }
+                    });
+            }
+        }
+    }
+
+    merge(conflicts);
+
+    return conflicts;
+}
+
+std::vector<hyx::Conflict> hyx::Conflict_index::conflicts(unsigned int threads) const
+{
+    std::array<std::vector<Conflict>, 7> found;
+
+    hyx::parallel_for(7, threads, [&](std::size_t first, std::size_t last) {
+        for (std::size_t weekday = first; weekday < last; ++weekday)
+        {
+            const std::vector<Interval>& day = this->days_[weekday];
+
+            // sorted by start, so everything that overlaps a meeting and starts no earlier comes right after it.
+            for (std::size_t i = 0; i < day.size(); ++i)
+            {
+                for (std::size_t j = i + 1; j < day.size() && day[j].start < day[i].end; ++j)
+                {
+                    const Interval& lhs = (day[i].course < day[j].course) ? day[i] : day[j];
+                    const Interval& rhs = (day[i].course < day[j].course) ? day[j] : day[i];
+
+                    if (lhs.course != rhs.course
+                        && share_weekday(lhs.first_day, lhs.last_day, rhs.first_day, rhs.last_day, static_cast<int>(weekday)))
+                    {
+                        found[weekday].push_back({ lhs.course, lhs.lab, rhs.course, rhs.lab, static_cast<std::uint8_t>(1 << weekday) });
+                    }
+                }
+            }
+        }
+        });
+
+    std::vector<Conflict> conflicts;
+
+    for (const auto& day : found)
+    {
+        conflicts.insert(conflicts.end(), day.begin(), day.end());
+    }
+
+    merge(conflicts);
+
+    return conflicts;
+}
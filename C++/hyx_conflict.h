@@ -0,0 +1,82 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#ifndef HYX_CONFLICT_H
+#define HYX_CONFLICT_H
+
+#include <array> // array
+#include <cstddef> // size_t
+#include <cstdint> // int32_t, uint8_t, uint16_t, uint32_t
+#include <vector> // vector
+
+#include "hyx_course.h"
+
+
+namespace hyx
+{
+    // two meetings that share a weekday, a stretch of dates with that weekday in it, and some minutes of the day.
+    struct Conflict
+    {
+        std::uint32_t first;
+        bool first_lab;
+        std::uint32_t second;
+        bool second_lab;
+
+        // the weekdays they clash on, as bits of Schedule::week_days.
+        std::uint8_t week_days;
+    };
+
+    // the lecture and lab meetings of a set of courses, indexed per weekday.
+    // every weekday keeps its meetings sorted by start time as an implicit interval tree: each node also holds the latest end
+    // in its subtree, so a lookup visits O(log n) nodes plus the meetings it finds.
+    class Conflict_index
+    {
+    private:
+
+        struct Interval
+        {
+            std::int32_t first_day;
+            std::int32_t last_day;
+            std::uint16_t start;
+            std::uint16_t end;
+
+            // latest end in the subtree under this node.
+            std::uint16_t max_end;
+            bool lab;
+            std::uint32_t course;
+        };
+
+        std::vector<const Course*> courses_;
+        std::array<std::vector<Interval>, 7> days_;
+
+        // height of each weekday's tree.
+        std::array<int, 7> levels_;
+
+        // calls found(interval) for every interval of the weekday that overlaps [start, end) in minutes.
+        template <class Found>
+        void find(int weekday, std::uint16_t start, std::uint16_t end, Found&& found) const;
+
+    public:
+
+        // a course without a time, or a lab without one, is left out; so are dates and times that do not make sense.
+        explicit Conflict_index(std::vector<const Course*> courses);
+
+        [[nodiscard]] std::size_t size() const noexcept;
+
+        // conflicts of course with the indexed courses; first is always 0. a course never conflicts with itself.
+        [[nodiscard]] std::vector<Conflict> check(const Course& course) const;
+
+        // conflicts of each proposed course with the indexed ones: first indexes proposed and second the indexed courses.
+        [[nodiscard]] std::vector<Conflict> check(const std::vector<const Course*>& proposed) const;
+
+        // every pair of indexed courses that conflict, first < second, sorted; the weekdays are swept in parallel.
+        [[nodiscard]] std::vector<Conflict> conflicts(unsigned int threads = 1) const;
+
+    };
+
+} // hyx
+
+#endif // !HYX_CONFLICT_H
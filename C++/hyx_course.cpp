@@ -5,238 +5,371 @@
  */
 
 #include "hyx_course.h"
-
-#include <algorithm> //transform, for_each, max_element
-#include <cmath> //floor
-#include <cstdlib> //strtod
-#include <ctime> //tm, strftime
-#include <functional> //divides
-#include <iomanip> //setw, left, right
-#include <iterator> //back_inserter
-#include <numeric> //accumulate
+#include "hyx_kernel.h"
+#include "hyx_parallel.h"
+#include "hyx_stats.h"
+
+#include <algorithm> //max, min, transform, for_each, partial_sort, replace_if, sort, unique, upper_bound
+#include <charconv> //to_chars, from_chars, chars_format
+#include <cmath> //abs, ceil, isnan
+#include <ctime> //tm
+#include <limits> //numeric_limits
+#include <numeric> //iota
 #include <ostream> //ostream
 #include <sstream> //stringstream
 #include <string> //string
+#include <tuple> //tie
+
+static void append_integer(std::string& out, long value) noexcept;
+
+static void append_decimal(std::string& out, double value, std::chars_format format, int precision) noexcept;
+
+static void append_padding(std::string& out, std::size_t start, std::size_t width) noexcept;
 
-static const std::string vec_helper(std::vector<std::string> vec) noexcept;
+static std::tm to_tm_date(std::int32_t day) noexcept;
 
-const std::vector<std::string> weave(const std::vector<std::unordered_map<std::string, std::string>>& vec) noexcept;
+static std::tm to_tm_time(std::uint16_t minute) noexcept;
 
-static const std::string to_ISO_date(std::tm date_time) noexcept;
+static double score_perc(double earned, double possible) noexcept;
 
-static const std::string to_ISO_time(std::tm date_time) noexcept;
+static void select_lowest(const double* earned, const double* possible, std::size_t count, std::size_t window, std::vector<double>& percents,
+    std::vector<std::size_t>& order, std::vector<std::size_t>& lowest);
 
+static std::size_t sum_kept(const double* earned, const double* possible, std::size_t count, const std::vector<std::size_t>& lowest, int drops,
+    const double* replacement, std::vector<std::pair<std::size_t, bool>>& marked, double& kept_earned, double& kept_possible, bool& has_kept);
 
-std::ostream& hyx::operator<<(std::ostream& os, const hyx::Grade_scale& scale) noexcept
+
+double score_perc(double earned, double possible) noexcept
 {
-    for (auto& itr : scale)
-    {
-        os << std::left << std::setw(2) << itr.first << ": [" << itr.second.first << "-" << itr.second.second << "]\n";
-    }
+    double perc = earned / possible;
 
-    return os;
+    // ungraded (0/0) scores sort below everything so they are dropped before a real score.
+    return (std::isnan(perc)) ? -std::numeric_limits<double>::infinity() : perc;
 }
 
-const std::string vec_helper(std::vector<std::string> vec) noexcept
+// the (drops + replacements) lowest grades by percentage, lowest first; percents and order are working space.
+void select_lowest(const double* earned, const double* possible, std::size_t count, std::size_t window, std::vector<double>& percents,
+    std::vector<std::size_t>& order, std::vector<std::size_t>& lowest)
 {
-    std::string str_vec;
+    percents.resize(count);
+    hyx::kernel::divide(earned, possible, percents.data(), count);
 
-    if (not vec.empty())
-    {
-        for (size_t i = 0; i < vec.size() - 1; ++i)
-        {
-            str_vec.append(' ' + vec[i] + '\n');
-        }
+    // ungraded (0/0) scores sort below everything so they are dropped before a real score.
+    std::replace_if(percents.begin(), percents.end(), [](double perc) { return std::isnan(perc); }, -std::numeric_limits<double>::infinity());
 
-        str_vec.append(' ' + vec[vec.size() - 1]);
-    }
+    order.resize(count);
+    std::iota(order.begin(), order.end(), 0);
+
+    // ties go to the earlier grade, the same one min_element would pick.
+    std::partial_sort(order.begin(), order.begin() + window, order.end(), [&](std::size_t lhs, std::size_t rhs) {
+        return percents[lhs] < percents[rhs] || (percents[lhs] == percents[rhs] && lhs < rhs);
+        });
 
-    return str_vec;
+    lowest.assign(order.begin(), order.begin() + window);
 }
 
-const std::vector<std::string> weave(const std::vector<std::unordered_map<std::string, std::string>>& vec) noexcept
+// totals of the grades that still count; replacement is the (earned, possible) grade that replaces, or null, and marked is working space.
+// returns how many grades it replaced.
+std::size_t sum_kept(const double* earned, const double* possible, std::size_t count, const std::vector<std::size_t>& lowest, int drops,
+    const double* replacement, std::vector<std::pair<std::size_t, bool>>& marked, double& kept_earned, double& kept_possible, bool& has_kept)
 {
-    std::vector<std::string> fabric;
+    kept_earned = 0.0;
+    kept_possible = 0.0;
+    has_kept = false;
+
+    // if there are points to calculate
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    // without drops or replacements every grade counts so the totals are plain sums.
+    if (lowest.empty())
+    {
+        std::tie(kept_earned, kept_possible) = hyx::kernel::sum_pair(earned, possible, count);
+        has_kept = true;
+
+        return 0;
+    }
+
+    // the lowest grades are dropped, the next ones are replaced while the replacement is better.
+    std::size_t dropped = std::min(lowest.size(), static_cast<std::size_t>(std::max(drops, 0)));
+    std::size_t replaced = dropped;
+    double repl_earned = 0.0;
+    double repl_poss = 0.0;
 
-    for (const auto &item : vec[0])
+    if (replacement != nullptr)
     {
-        fabric.push_back(item.first);
+        repl_earned = replacement[0];
+        repl_poss = replacement[1];
+
+        double repl_perc = repl_earned / repl_poss;
+
+        while (replaced < lowest.size() && repl_perc > score_perc(earned[lowest[replaced]], possible[lowest[replaced]]))
+        {
+            ++replaced;
+        }
     }
 
-    size_t pad = 2 + (*std::max_element(fabric.begin(), fabric.end(), [](const std::string& Lstr, const std::string& Rstr) { return Lstr.length() < Rstr.length(); })).length();
+    // index; replaced (otherwise dropped)
+    marked.clear();
 
-    for (size_t i = 0; i < vec[0].size(); ++i)
+    for (std::size_t i = 0; i < replaced; ++i)
     {
-        std::stringstream ss;
+        marked.emplace_back(lowest[i], i >= dropped);
+    }
+
+    std::sort(marked.begin(), marked.end());
 
-        ss << std::left << std::setw(pad) << fabric[i]
-           << "[" << std::setw(7);
+    // one pass in index order, the same order adding the grades one by one gives, so the totals do not depend on how the window was built.
+    auto mark = marked.begin();
 
-        // not clean but works to get either a weight number or string (like N/A)
-        if (fabric[i] == "EXTRA")
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (mark != marked.end() && mark->first == i)
         {
-            ss << vec[1].at(fabric[i]);
+            if (mark->second)
+            {
+                kept_earned += repl_earned;
+                kept_possible += repl_poss;
+            }
+
+            ++mark;
         }
         else
         {
-            ss << std::setprecision(4) << std::strtod(vec[1].at(fabric[i]).c_str(), nullptr);
+            kept_earned += earned[i];
+            kept_possible += possible[i];
         }
-        
-        ss << "weight | "
-           << std::setw(3) << vec[2].at(fabric[i]) << " drops]"
-           << std::right << std::setw(0) << "  " << vec[0].at(fabric[i]);
+    }
+
+    // if all of the grades have been dropped then treat as if no grades have been given
+    has_kept = count > dropped;
 
-        // we overwrite with the full line.
-        fabric[i] = ss.str();
+    return replaced - dropped;
+}
+
+void append_integer(std::string& out, long value) noexcept
+{
+    char buff[24];
+
+    out.append(buff, std::to_chars(buff, buff + sizeof(buff), value).ptr);
+}
+
+void append_decimal(std::string& out, double value, std::chars_format format, int precision) noexcept
+{
+    // wide enough for any double in fixed notation.
+    char buff[384];
+
+    out.append(buff, std::to_chars(buff, buff + sizeof(buff), value, format, precision).ptr);
+}
+
+void append_padding(std::string& out, std::size_t start, std::size_t width) noexcept
+{
+    if (out.size() - start < width)
+    {
+        out.append(width - (out.size() - start), ' ');
     }
+}
+
+// the fields a std::tm of the date has always had; no_date comes back as {0, 0, 0} did.
+std::tm to_tm_date(std::int32_t day) noexcept
+{
+    std::array<int, 3> date = hyx::schedule::civil_from_days(day);
+    std::tm tm_date{};
+
+    tm_date.tm_year = date[0] - 1900;
+    tm_date.tm_mon = date[1] - 1;
+    tm_date.tm_mday = date[2];
 
-    return fabric;
+    return tm_date;
+}
+
+// no_time comes back as an hour and minute of -1.
+std::tm to_tm_time(std::uint16_t minute) noexcept
+{
+    std::array<int, 2> time = hyx::schedule::unpack_time(minute);
+    std::tm tm_time{};
+
+    tm_time.tm_hour = time[0];
+    tm_time.tm_min = time[1];
+
+    return tm_time;
 }
 
 std::ostream& hyx::operator<<(std::ostream& os, const hyx::Course& course) noexcept
 {
-    std::stringstream ss;
+    // reused so printing many courses does not allocate once it has grown.
+    thread_local std::string report;
 
-    ss << "Course Name: " << course.get_name() << '\n'
-        << "Institution: " << course.get_institution() << '\n'
-        << "Details: " << course.get_details() << '\n'
-        << "CRN: " << course.get_crn() << '\n'
-        << "Days: " << course.get_week_days() << '\n'
-        << "Time: " << to_ISO_time(course.get_start_time()) << " - " << to_ISO_time(course.get_end_time()) << '\n'
-        << "Date: " << to_ISO_date(course.get_start_date()) << " -- " << to_ISO_date(course.get_end_date()) << '\n'
-        << "Location: " << course.get_location() << '\n'
-        << "Instructor: " << course.get_instructor() << '\n'
-        << "Grade: " << ((course.get_grade() == -1) ? "N/A" : std::to_string(course.get_grade()) + "%") << '\n'
-        << "Letter: " << ((course.get_letter() == "") ? "N/A" : course.get_letter()) << '\n'
-        << "Credit Hours: " << course.get_units() << '\n'
-        << "Grade Points: "
-        << ((course.get_grade_points() == -1) ? "N/A" : std::to_string(course.get_grade_points())) << '\n'
-        << "Book(s):" << ((not course.get_books().empty()) ? "\n" : "") << vec_helper(course.get_books()) << '\n'
-        << "Points:" << ((course.get_points().empty()) ? "" : "\n" + vec_helper(weave({course.get_points(), course.get_weights(), course.get_drops()}))) << '\n';
-
-    return os << ss.str();
+    report.clear();
+    course.render(report);
+
+    return os.write(report.data(), static_cast<std::streamsize>(report.size()));
 }
 
 std::ostream& hyx::operator<<(std::ostream& os, const hyx::CourseWLAB& course) noexcept
 {
-    std::stringstream ss;
+    thread_local std::string report;
 
-    ss << "Course Name: " << course.get_name() << '\n'
-        << "Institution: " << course.get_institution() << '\n'
-        << "Details: " << course.get_details() << '\n'
-        << "CRN: " << course.get_crn() << '\n'
-        << "Days: " << course.get_week_days() << '\n'
-        << "Lab Days: " << course.get_lab_week_days() << '\n'
-        << "Time: " << to_ISO_time(course.get_start_time()) << " - " << to_ISO_time(course.get_end_time()) << '\n'
-        << "Date: " << to_ISO_date(course.get_start_date()) << " - " << to_ISO_date(course.get_end_date()) << '\n'
-        << "Lab Time: " << to_ISO_time(course.get_lab_start_time()) << " - " << to_ISO_time(course.get_lab_end_time()) << '\n'
-        << "Lab Date: " << to_ISO_date(course.get_lab_start_date()) << " - " << to_ISO_date(course.get_lab_end_date()) << '\n'
-        << "Location: " << course.get_location() << '\n'
-        << "Lab Location: " << course.get_location() << '\n'
-        << "Instructor: " << course.get_instructor() << '\n'
-        << "Grade: " << ((course.get_grade() == -1) ? "N/A" : std::to_string(course.get_grade())) << '\n'
-        << "Letter: " << ((course.get_letter() == "") ? "N/A" : course.get_letter()) << '\n'
-        << "Credit Hours: " << course.get_units() << '\n'
-        << "Grade Points: "
-        << ((course.get_grade_points() == -1) ? "N/A" : std::to_string(course.get_grade_points())) << '\n'
-        << "Book(s):" << ((not course.get_books().empty()) ? "\n" : "") << vec_helper(course.get_books()) << '\n'
-        << "Points:" << ((course.get_points().empty()) ? "" : "\n" + vec_helper(weave({course.get_points(), course.get_weights(), course.get_drops()}))) << '\n';
-
-    return os << ss.str();
+    report.clear();
+    course.render(report);
+
+    return os.write(report.data(), static_cast<std::streamsize>(report.size()));
+}
+
+hyx::Course::Category& hyx::Course::writable_category(Category_id id)
+{
+    return this->points_[id.index()].write();
 }
 
 void hyx::Course::update_letter() noexcept
 {
-    if (this->is_point_based())
-    {
-        for (auto &itr : this->scale_)
-        {
-             if (std::floor(this->grade_) >= (itr.second.first / this->base_points_ * 100) && std::floor(this->grade_) <= (itr.second.second / this->base_points_ * 100))
-            {
-                this->letter_ = itr.first;
-            }
-        }
-    }
-    else
+    HYX_STATS_TIME(update_letter);
+
+    std::uint8_t band = (this->is_point_based()) ? this->scale_->find(this->grade_, this->base_points_) : this->scale_->find(this->grade_);
+
+    if (band != Compiled_scale::npos)
     {
-        for (auto &itr : this->scale_)
+        // a new letter also replaces an incomplete.
+        if (this->status_ == Course_status::incomplete)
         {
-            if (std::floor(this->grade_) >= itr.second.first && std::floor(this->grade_) <= itr.second.second)
-            {
-                this->letter_ = itr.first;
-            }
+            this->status_ = Course_status::active;
         }
+
+        this->band_ = band;
     }
 }
 
 void hyx::Course::update_grade_points() noexcept
 {
+    HYX_STATS_TIME(update_grade_points);
+
     if (this->is_replaced() || this->is_withdrawn())
     {
         this->grade_points_ = -1.0;
     }
-    else if (this->letter_ == "A" || this->letter_ == "A+")
-    {
-        this->grade_points_ = 4.0 * this->units_;
-    }
-    else if (this->letter_ == "A-")
-    {
-        this->grade_points_ = 3.7 * this->units_;
-    }
-    else if (this->letter_ == "B+")
-    {
-        this->grade_points_ = 3.3 * this->units_;
-    }
-    else if (this->letter_ == "B")
+    else if (this->band_ != Compiled_scale::npos)
     {
-        this->grade_points_ = 3.0 * this->units_;
-    }
-    else if (this->letter_ == "B-")
-    {
-        this->grade_points_ = 2.7 * this->units_;
-    }
-    else if (this->letter_ == "C+")
-    {
-        this->grade_points_ = 2.3 * this->units_;
-    }
-    else if (this->letter_ == "C")
-    {
-        this->grade_points_ = 2.0 * this->units_;
+        double points = this->scale_->get_points(this->band_);
+
+        this->grade_points_ = (points < 0) ? -1.0f : static_cast<float>(points * this->units_);
     }
-    else if (this->letter_ == "C-")
+}
+
+bool hyx::Course::has_good_weights() const noexcept
+{
+    double total_weight = 0.0f;
+
+    std::for_each(this->points_.begin(), this->points_.end(),
+        [&](auto& itr) { total_weight += itr->weight; });
+
+    return (std::abs(1 - total_weight) < std::numeric_limits<float>::epsilon()) ? true : false;
+}
+
+void hyx::Course::update_category(Category_id id) noexcept
+{
+    Category& category = this->writable_category(id);
+    std::size_t count = this->scores_.size(id.index());
+
+    category.lowest.clear();
+
+    if (category.drops > 0 || category.replace.first > 0)
     {
-        this->grade_points_ = 1.7 * this->units_;
+        std::size_t window = std::min(count,
+            static_cast<std::size_t>(std::max(category.drops, 0)) + static_cast<std::size_t>(std::max(category.replace.first, 0)));
+
+        std::vector<double> percents;
+        std::vector<std::size_t> order;
+
+        select_lowest(this->scores_.earned(id.index()), this->scores_.possible(id.index()), count, window, percents, order, category.lowest);
     }
-    else if (this->letter_ == "D+")
+
+    this->update_kept(id);
+}
+
+void hyx::Course::update_kept(Category_id id) noexcept
+{
+    Category& category = this->writable_category(id);
+    const double* replacement = nullptr;
+    double first_grade[2] = { 0.0, 0.0 };
+
+    if (category.replace.first > 0 && category.replace_id && this->scores_.size(category.replace_id.index()) != 0)
     {
-        this->grade_points_ = 1.3 * this->units_;
+        first_grade[0] = this->scores_.earned(category.replace_id.index())[0];
+        first_grade[1] = this->scores_.possible(category.replace_id.index())[0];
+        replacement = first_grade;
     }
-    else if (this->letter_ == "D")
+
+    std::vector<std::pair<std::size_t, bool>> marked;
+    std::size_t replaced = sum_kept(this->scores_.earned(id.index()), this->scores_.possible(id.index()), this->scores_.size(id.index()),
+        category.lowest, category.drops, replacement, marked, category.kept_earned, category.kept_possible, category.has_kept);
+
+    // counted here rather than in sum_kept, so projections, which only work out grades, stay out of the totals.
+    HYX_STATS_COUNT(drops, std::min(category.lowest.size(), static_cast<std::size_t>(std::max(category.drops, 0))));
+    HYX_STATS_COUNT(replacements, replaced);
+}
+
+void hyx::Course::add_to_category(Category_id id, double earn, double poss) noexcept
+{
+    Category& category = this->writable_category(id);
+
+    this->scores_.push_back(id.index(), earn, poss);
+
+    if (category.drops <= 0 && category.replace.first <= 0)
     {
-        this->grade_points_ = 1.0 * this->units_;
+        // the new grade always counts, so the running totals are extended in place.
+        category.kept_earned += earn;
+        category.kept_possible += poss;
+        category.has_kept = true;
+
+        return;
     }
-    else if (this->letter_ == "D-")
+
+    const double* earned = this->scores_.earned(id.index());
+    const double* possible = this->scores_.possible(id.index());
+    std::size_t window = static_cast<std::size_t>(std::max(category.drops, 0)) + static_cast<std::size_t>(std::max(category.replace.first, 0));
+    double perc = score_perc(earn, poss);
+
+    // the new grade has the highest index, so it goes after any grade with the same percentage.
+    auto pos = std::upper_bound(category.lowest.begin(), category.lowest.end(), perc,
+        [&](double value, std::size_t i) { return value < score_perc(earned[i], possible[i]); });
+
+    if (pos == category.lowest.end() && category.lowest.size() >= window)
     {
-        this->grade_points_ = 0.7 * this->units_;
+        // it is above every dropped or replaceable grade, so it simply counts.
+        category.kept_earned += earn;
+        category.kept_possible += poss;
+        category.has_kept = true;
     }
-    else if (this->letter_ == "F")
+    else
     {
-        this->grade_points_ = 0.0 * this->units_;
+        category.lowest.insert(pos, this->scores_.size(id.index()) - 1);
+
+        if (category.lowest.size() > window)
+        {
+            category.lowest.pop_back();
+        }
+
+        this->update_kept(id);
     }
 }
 
-bool hyx::Course::has_good_weights() noexcept
+void hyx::Course::update_dependents(Category_id id) noexcept
 {
-    double total_weight = 0.0f;
-
-    std::for_each(this->points_.begin(), this->points_.end(),
-        [&](auto& itr) { total_weight += std::get<2>(itr.second); });
-
-    return (std::abs(1 - total_weight) < std::numeric_limits<float>::epsilon()) ? true : false;
+    for (std::size_t i = 0; i < this->points_.size(); ++i)
+    {
+        if (this->points_[i]->replace.first > 0 && this->points_[i]->replace_id == id)
+        {
+            this->update_category(Category_id(static_cast<std::uint32_t>(i)));
+        }
+    }
 }
 
 bool hyx::Course::update_grade() noexcept
 {
+    HYX_STATS_TIME(update_grade);
+
     if (not this->is_withdrawn() && not this->is_replaced() && (this->has_good_weights() || this->is_point_based()))
     {
         double final_grade = 0.0f;
@@ -246,73 +379,31 @@ bool hyx::Course::update_grade() noexcept
         double total_earned_points = 0.0f;
         double total_possible_points = 0.0f;
 
-        for (auto& itr : this->points_)
+        bool has_grades = false;
+
+        // every category keeps its own totals up to date, so we only combine them here.
+        for (const auto& itr : this->points_)
         {
-            // if there are points to calculate
-            if (std::get<0>(itr.second).empty())
+            has_grades = has_grades || itr->has_kept;
+
+            if (not itr->has_kept)
+            {
+                unused_weight += itr->weight;
+            }
+            else if (this->is_point_based())
             {
-                unused_weight += std::get<2>(itr.second);
+                total_earned_points += itr->kept_earned;
+                total_possible_points += itr->kept_possible;
             }
             else
             {
-                std::vector<double> points_earned(std::get<0>(itr.second));
-                std::vector<double> points_poss(std::get<1>(itr.second));
-
-                // if we need to drop or replace
-                if (std::get<3>(itr.second) > 0 || std::get<4>(itr.second).first > 0)
-                {
-                    std::vector<double> points_perc;
-                    std::transform(points_earned.begin(), points_earned.end(), points_poss.begin(), std::back_inserter(points_perc), std::divides<double>());//divide(points_earned, points_poss);
-                
-                    // drop lowest grades as necessary
-                    for (int i = 0; i < std::get<3>(itr.second) && points_perc.size() != 0; ++i)
-                    {
-                        ptrdiff_t min_index = std::distance(points_perc.begin(), std::min_element(points_perc.begin(), points_perc.end()));
-                    
-                        points_perc.erase(points_perc.begin() + min_index);
-                        points_earned.erase(points_earned.begin() + min_index);
-                        points_poss.erase(points_poss.begin() + min_index);
-                    }
-
-                    // replace grades as necessary
-                    for (int i = 0; i < std::get<4>(itr.second).first && this->points_.count(std::get<4>(itr.second).second) && not std::get<0>(this->points_[std::get<4>(itr.second).second]).empty() && not points_perc.empty(); ++i)
-                    {
-                        double repl_perc = std::get<0>(this->points_[std::get<4>(itr.second).second]).front() / std::get<1>(this->points_[std::get<4>(itr.second).second]).front();
-
-                        if (repl_perc > *std::min_element(points_perc.begin(), points_perc.end()))
-                        {
-                            ptrdiff_t min_index = std::distance(points_perc.begin(), std::min_element(points_perc.begin(), points_perc.end()));
-
-                            points_perc.erase(points_perc.begin() + min_index);
-                            points_earned[min_index] = std::get<0>(this->points_[std::get<4>(itr.second).second]).front();
-                            points_poss[min_index] = std::get<1>(this->points_[std::get<4>(itr.second).second]).front();
-                        }
-                    }
-                }
-
-                // if all of the grades have been dropped then treat as if no grades have been given
-                if (points_earned.empty())
-                {
-                    unused_weight += std::get<2>(itr.second);
-                }
-                else
-                {
-                    if (this->is_point_based())
-                    {
-                        total_earned_points += std::accumulate(points_earned.begin(), points_earned.end(), 0.0);
-                        total_possible_points += std::accumulate(points_poss.begin(), points_poss.end(), 0.0);
-                    }
-                    else
-                    {
-                        // sum group's grades and apply its weights
-                        final_grade += std::get<2>(itr.second) * (std::accumulate(points_earned.begin(), points_earned.end(), 0.0) / std::accumulate(points_poss.begin(), points_poss.end(), 0.0));
-                    }
-                }
+                // apply the group's weight to its grade
+                final_grade += itr->weight * (itr->kept_earned / itr->kept_possible);
             }
         }
 
         // update stats if there are grades left over.
-        if (unused_weight != 1 || total_possible_points != 0)
+        if (has_grades)
         {
             this->grade_ = (this->is_point_based()) ? ((total_earned_points + this->extra_) / total_possible_points) * 100 : final_grade * 100 / (1 - unused_weight) + this->extra_;
             this->update_letter();
@@ -331,7 +422,7 @@ hyx::Course::Course(
     std::string name,
     long crn,
     int units,
-    Grade_scale scale,
+    Shared_scale scale,
     std::string institution,
     std::string location,
     std::string instructor,
@@ -342,22 +433,18 @@ hyx::Course::Course(
     std::array<int, 2> start_time,
     std::array<int, 2> end_time
 ) :
-    name_(name),
+    info_(Info{ name, institution, location, instructor, details, {} }),
     crn_(crn),
     units_(units),
     scale_(scale),
-    institution_(institution),
-    location_(location),
-    instructor_(instructor),
-    details_(details),
-    week_days_(week_days),
-    start_datetime_({ start_date[0], start_date[1], start_date[2], start_time[0], start_time[1] }),
-    end_datetime_({ end_date[0], end_date[1], end_date[2], end_time[0], end_time[1] }),
-    books_(),
+    schedule_(Schedule::pack(week_days, start_date, end_date, start_time, end_time)),
     grade_(-1),
-    letter_(),
+    status_(Course_status::active),
+    band_(Compiled_scale::npos),
     grade_points_(-1),
     points_(),
+    category_ids_(std::unordered_map<std::string, Category_id>()),
+    scores_(),
     extra_(0),
     base_points_(0)
 {
@@ -365,7 +452,7 @@ hyx::Course::Course(
 
 const std::string& hyx::Course::get_name() const noexcept
 {
-    return this->name_;
+    return this->info_->name;
 }
 
 long hyx::Course::get_crn() const noexcept
@@ -382,7 +469,7 @@ const std::string hyx::Course::get_scale() const noexcept
 {
     std::stringstream ss;
 
-    ss << this->scale_;
+    ss << *this->scale_;
 
     std::string str_scale = ss.str();
 
@@ -396,121 +483,61 @@ const std::string hyx::Course::get_scale() const noexcept
 
 const std::string& hyx::Course::get_institution() const noexcept
 {
-    return this->institution_;
+    return this->info_->institution;
 }
 
 const std::string& hyx::Course::get_location() const noexcept
 {
-    return this->location_;
+    return this->info_->location;
 }
 
 const std::string& hyx::Course::get_instructor() const noexcept
 {
-    return this->instructor_;
+    return this->info_->instructor;
 }
 
 const std::string& hyx::Course::get_details() const noexcept
 {
-    return this->details_;
+    return this->info_->details;
 }
 
-const std::string week_day_helper(const std::array<bool, 8>& week_days)
+const std::string hyx::Course::get_week_days() const noexcept
 {
     std::string str_week_days;
 
-    std::string LUT_week_days = { '-', 'U', 'M', 'T', 'W', 'R', 'F', 'S' };
-
-    int i = 0;
-
-    // if we start with monday - skip checking sunday for now.
-    if (week_days[7] == true)
-    {
-        ++i;
-    }
-
-    for (; i < 7; ++i)
-    {
-        str_week_days.push_back(LUT_week_days[week_days[i] * (i + 1)]);
-    }
-
-    // if we start with monday - we can check sunday now.
-    if (week_days[7] == true)
-    {
-        str_week_days.push_back(LUT_week_days[week_days[0] * 1]);
-    }
+    hyx::schedule::append_week_days(str_week_days, this->schedule_.week_days);
 
     return str_week_days;
 }
 
-const std::string hyx::Course::get_week_days() const noexcept
-{
-    return week_day_helper(this->week_days_);
-}
-
-const std::string to_ISO_date(std::tm date) noexcept
-{
-    char buff[11];
-
-    std::strftime(buff, 11, "%Y-%m-%d", &date);
-
-    return buff;
-}
-
 const std::tm hyx::Course::get_start_date() const noexcept
 {
-    std::tm date{};
-    date.tm_year = this->start_datetime_[0] - 1900;
-    date.tm_mon = this->start_datetime_[1] - 1;
-    date.tm_mday = this->start_datetime_[2];
-
-    return date;
+    return to_tm_date(this->schedule_.start_day);
 }
 
 const std::tm hyx::Course::get_end_date() const noexcept
 {
-    std::tm date{};
-    date.tm_year = this->end_datetime_[0] - 1900;
-    date.tm_mon = this->end_datetime_[1] - 1;
-    date.tm_mday = this->end_datetime_[2];
-
-    return date;
-}
-
-const std::string to_ISO_time(std::tm time) noexcept
-{
-    if (time.tm_hour == -1 || time.tm_min == -1)
-    {
-        return "";
-    }
-
-    char buff[9];
-
-    std::strftime(buff, 9, "%I:%M %p", &time);
-
-    return buff;
+    return to_tm_date(this->schedule_.end_day);
 }
 
 const std::tm hyx::Course::get_start_time() const noexcept
 {
-    std::tm time{};
-    time.tm_hour = this->start_datetime_[3];
-    time.tm_min = this->start_datetime_[4];
-
-    return time;
+    return to_tm_time(this->schedule_.start_minute);
 }
 
 const std::tm hyx::Course::get_end_time() const noexcept
 {
-    std::tm time{};
-    time.tm_hour = this->end_datetime_[3];
-    time.tm_min = this->end_datetime_[4];
+    return to_tm_time(this->schedule_.end_minute);
+}
 
-    return time;
+const hyx::Schedule& hyx::Course::get_schedule() const noexcept
+{
+    return this->schedule_;
 }
 
 const std::vector<std::string>& hyx::Course::get_books() const noexcept
 {
-    return this->books_;
+    return this->info_->books;
 }
 
 double hyx::Course::get_grade() const noexcept
@@ -518,9 +545,21 @@ double hyx::Course::get_grade() const noexcept
     return this->grade_;
 }
 
-const std::string hyx::Course::get_letter() const noexcept
+const std::string& hyx::Course::get_letter() const noexcept
+{
+    static const std::string status_letters[] = { "", "W", "R", "I" };
+
+    if (this->status_ != Course_status::active || this->band_ == Compiled_scale::npos)
+    {
+        return status_letters[static_cast<std::size_t>(this->status_)];
+    }
+
+    return this->scale_->get_letter(this->band_);
+}
+
+hyx::Course_status hyx::Course::get_status() const noexcept
 {
-    return this->letter_;
+    return this->status_;
 }
 
 float hyx::Course::get_grade_points() const noexcept
@@ -530,26 +569,31 @@ float hyx::Course::get_grade_points() const noexcept
 
 const std::unordered_map<std::string, std::string> hyx::Course::get_points() const noexcept
 {
+    HYX_STATS_TIME(get_points);
+
     std::unordered_map<std::string, std::string> vstr_points;
 
-    for (auto& itr : this->points_)
+    for (std::uint32_t id = 0; id < this->points_.size(); ++id)
     {
-        if (itr.first != "")
+        if (this->points_[id]->name != "")
         {
             std::stringstream ss;
 
-            // both earned and possible point vectors WILL always be the same size.
-            for (size_t i = 0; i < std::get<0>(itr.second).size(); ++i)
+            const double* earned = this->scores_.earned(id);
+            const double* possible = this->scores_.possible(id);
+            std::size_t count = this->scores_.size(id);
+
+            for (size_t i = 0; i < count; ++i)
             {
-                ss << std::get<0>(itr.second)[i] << '/' << std::get<1>(itr.second)[i];
+                ss << earned[i] << '/' << possible[i];
 
-                if (i != std::get<0>(itr.second).size() - 1)
+                if (i != count - 1)
                 {
                     ss << ", ";
                 }
             }
 
-            vstr_points.emplace(itr.first, ss.str());
+            vstr_points.emplace(this->points_[id]->name, ss.str());
         }
     }
 
@@ -559,6 +603,8 @@ const std::unordered_map<std::string, std::string> hyx::Course::get_points() con
         vstr_points.emplace("EXTRA", std::to_string(this->extra_) + ((this->is_point_based()) ? "" : "%"));
     }
 
+    HYX_STATS_COUNT(points_entries, vstr_points.size());
+
     return vstr_points;
 }
 
@@ -566,11 +612,11 @@ const std::unordered_map<std::string, std::string> hyx::Course::get_weights() co
 {
     std::unordered_map<std::string, std::string> vstr_weights;
     
-    for (auto& itr : this->points_)
+    for (const auto& itr : this->points_)
     {
-        if (itr.first != "")
+        if (itr->name != "")
         {
-            vstr_weights.emplace(itr.first, std::to_string(std::get<2>(itr.second)));
+            vstr_weights.emplace(itr->name, std::to_string(itr->weight));
         }
     }
 
@@ -587,12 +633,12 @@ const std::unordered_map<std::string, std::string> hyx::Course::get_drops() cons
 {
     std::unordered_map<std::string, std::string> vstr_drops;
 
-    for (auto& itr : this->points_)
+    for (const auto& itr : this->points_)
     {
-        if (itr.first != "")
+        if (itr->name != "")
         {
 
-            vstr_drops.emplace(itr.first, std::to_string(std::get<3>(itr.second)));
+            vstr_drops.emplace(itr->name, std::to_string(itr->drops));
         }
     }
 
@@ -607,22 +653,22 @@ const std::unordered_map<std::string, std::string> hyx::Course::get_drops() cons
 
 bool hyx::Course::is_withdrawn() const noexcept
 {
-    return this->get_letter() == "W";
+    return this->status_ == Course_status::withdrawn;
 }
 
 bool hyx::Course::is_replaced() const noexcept
 {
-    return this->get_letter() == "R";
+    return this->status_ == Course_status::replaced;
 }
 
 bool hyx::Course::is_incomplete() const noexcept
 {
-    return this->get_letter() == "I";
+    return this->status_ == Course_status::incomplete;
 }
 
 bool hyx::Course::is_included_in_gpa() const noexcept
 {
-    return !(this->is_withdrawn() || this->is_replaced() || this->is_incomplete() || this->get_grade_points() == -1.0f || this->scale_ == hyx::scale::PF);
+    return !(this->is_withdrawn() || this->is_replaced() || this->is_incomplete() || this->get_grade_points() == -1.0f || this->scale_ == hyx::scale::shared::PF());
 }
 
 bool hyx::Course::is_point_based() const noexcept
@@ -634,27 +680,28 @@ void hyx::Course::set_withdrawn() noexcept
 {
     this->grade_ = 0;
 
-    this->letter_ = "W";
+    this->status_ = Course_status::withdrawn;
     this->update_grade_points();
 }
 
 void hyx::Course::set_replaced() noexcept
 {
-    this->letter_ = "R";
+    this->status_ = Course_status::replaced;
 
     this->update_grade_points();
 }
 
 void hyx::Course::set_incomplete() noexcept
 {
-    this->letter_ = "I";
+    this->status_ = Course_status::incomplete;
 
     this->update_grade_points();
 }
 
 void hyx::Course::set_pass_fail() noexcept
 {
-    this->scale_ = hyx::scale::PF;
+    this->scale_ = hyx::scale::shared::PF();
+    this->band_ = Compiled_scale::npos;
 
     this->update_grade();
 }
@@ -668,7 +715,7 @@ bool hyx::Course::add_book(std::string book) noexcept
 {
     if (not this->is_withdrawn() && not this->is_replaced())
     {
-        this->books_.push_back(book);
+        this->info_.write().books.push_back(book);
 
         return true;
     }
@@ -676,7 +723,17 @@ bool hyx::Course::add_book(std::string book) noexcept
     return false;
 }
 
-bool hyx::Course::add_category(std::string name, double weight, int drop, std::pair<int, std::string> replace)
+hyx::Category_id hyx::Course::get_category(std::string name) const noexcept
+{
+    std::transform(name.begin(), name.end(), name.begin(),
+        [](unsigned char c) { return toupper(c); });
+
+    auto itr = this->category_ids_->find(name);
+
+    return (itr != this->category_ids_->end()) ? itr->second : Category_id();
+}
+
+hyx::Category_id hyx::Course::add_category(std::string name, double weight, int drop, std::pair<int, std::string> replace)
 {
     if (not this->is_withdrawn() && not this->is_replaced())
     {
@@ -686,134 +743,901 @@ bool hyx::Course::add_category(std::string name, double weight, int drop, std::p
         std::transform(replace.second.begin(), replace.second.end(), replace.second.begin(),
             [](unsigned char c) { return toupper(c); });
 
-        this->points_[name];
-        std::get<2>(this->points_[name]) = weight;
-        std::get<3>(this->points_[name]) = drop;
-        std::get<4>(this->points_[name]) = replace;
+        auto id_itr = this->category_ids_->find(name);
+        Category_id id = (id_itr != this->category_ids_->end()) ? id_itr->second : Category_id(static_cast<std::uint32_t>(this->points_.size()));
 
-        return true;
+        if (id_itr == this->category_ids_->end())
+        {
+            this->points_.emplace_back(Category{ name, 0.0, 0, { 0, "" }, Category_id(), {}, 0.0, 0.0, false });
+            this->scores_.add_category();
+            this->category_ids_.write().emplace(name, id);
+
+            // categories that named this one as their replacement can now point at it.
+            for (std::uint32_t i = 0; i < this->points_.size(); ++i)
+            {
+                if (this->points_[i]->replace.second == name)
+                {
+                    this->writable_category(Category_id(i)).replace_id = id;
+                }
+            }
+        }
+
+        Category& category = this->writable_category(id);
+        category.weight = weight;
+        category.drops = drop;
+        category.replace = replace;
+        category.replace_id = this->get_category(replace.second);
+
+        this->update_category(id);
+
+        return id;
     }
 
-    return false;
+    return Category_id();
 }
 
-bool hyx::Course::add_grade(std::string name, double earn, double poss) noexcept
+bool hyx::Course::add_grade(Category_id id, double earn, double poss) noexcept
 {
-    std::transform(name.begin(), name.end(), name.begin(),
-        [](unsigned char c) { return toupper(c); });
-
-    if (this->points_.count(name) && not this->is_withdrawn() && not this->is_replaced())
+    if (id && id.index() < this->points_.size() && not this->is_withdrawn() && not this->is_replaced())
     {
-        std::get<0>(this->points_[name]).push_back(earn);
-        std::get<1>(this->points_[name]).push_back(poss);
+        this->add_to_category(id, earn, poss);
+
+        // only the first grade of a category is used as a replacement.
+        if (this->scores_.size(id.index()) == 1)
+        {
+            this->update_dependents(id);
+        }
 
         this->update_grade();
 
         return true;
     }
-    
+
     return false;
 }
 
-void hyx::Course::add_extra_to_total(double extra)
+bool hyx::Course::add_grade(std::string name, double earn, double poss) noexcept
 {
-    this->extra_ += extra;
-
-    this->update_grade();
+    return this->add_grade(this->get_category(std::move(name)), earn, poss);
 }
 
-hyx::CourseWLAB::CourseWLAB(
-    std::string name,
-    long crn,
-    int units,
-    Grade_scale scale,
-    std::string institution,
-    std::string location,
-    std::string lab_location,
-    std::string instructor,
-    std::string details,
-    std::array<bool, 8> week_days,
-    std::array<bool, 8> lab_week_days,
-    std::array<int, 3> start_date,
-    std::array<int, 3> end_date,
-    std::array<int, 3> lab_start_date,
-    std::array<int, 3> lab_end_date,
-    std::array<int, 2> start_time,
-    std::array<int, 2> end_time,
-    std::array<int, 2> lab_start_time,
-    std::array<int, 2> lab_end_time
-) :
-    Course(
-        name,
-        crn,
-        units,
-        scale,
-        institution,
-        location,
-        instructor,
-        details,
-        week_days,
-        start_date,
-        end_date,
-        start_time,
-        end_time),
-    lab_location_(lab_location),
-    lab_week_days_(lab_week_days),
-    lab_start_datetime_({ lab_start_date[0], lab_start_date[1], lab_start_date[2], lab_start_time[0], lab_start_time[1] }),
-    lab_end_datetime_({ lab_end_date[0], lab_end_date[1], lab_end_date[2], lab_end_time[0], lab_end_time[1] })
+std::size_t hyx::Course::add_grades(const std::vector<Grade_record>& grades) noexcept
 {
-}
+    if (this->is_withdrawn() || this->is_replaced())
+    {
+        return 0;
+    }
+
+    std::vector<std::size_t> counts(this->points_.size(), 0);
+
+    for (const auto& grade : grades)
+    {
+        if (grade.category && grade.category.index() < this->points_.size())
+        {
+            ++counts[grade.category.index()];
+        }
+    }
+
+    std::vector<bool> was_empty(this->points_.size());
+
+    for (std::size_t i = 0; i < this->points_.size(); ++i)
+    {
+        was_empty[i] = this->scores_.size(static_cast<std::uint32_t>(i)) == 0;
+
+        std::size_t needed = this->scores_.size(static_cast<std::uint32_t>(i)) + counts[i];
+
+        // grow geometrically so a long run of small batches stays linear.
+        if (needed > this->scores_.capacity(static_cast<std::uint32_t>(i)))
+        {
+            this->scores_.reserve(static_cast<std::uint32_t>(i), std::max(needed, this->scores_.capacity(static_cast<std::uint32_t>(i)) * 2));
+        }
+    }
+
+    std::size_t added = 0;
+
+    for (const auto& grade : grades)
+    {
+        if (grade.category && grade.category.index() < this->points_.size())
+        {
+            this->scores_.push_back(grade.category.index(), grade.earned, grade.possible);
+
+            Category& category = this->writable_category(grade.category);
+
+
+            if (category.drops <= 0 && category.replace.first <= 0)
+            {
+                category.kept_earned += grade.earned;
+                category.kept_possible += grade.possible;
+                category.has_kept = true;
+            }
+
+            ++added;
+        }
+    }
+
+    // categories with drops or replacements are settled once, after all of their grades are in.
+    for (std::size_t i = 0; i < this->points_.size(); ++i)
+    {
+        if (counts[i] != 0 && (this->points_[i]->drops > 0 || this->points_[i]->replace.first > 0))
+        {
+            this->update_category(Category_id(static_cast<std::uint32_t>(i)));
+        }
+    }
+
+    for (std::size_t i = 0; i < this->points_.size(); ++i)
+    {
+        if (counts[i] != 0 && was_empty[i])
+        {
+            this->update_dependents(Category_id(static_cast<std::uint32_t>(i)));
+        }
+    }
+
+    if (added != 0)
+    {
+        this->update_grade();
+    }
+
+    return added;
+}
+
+std::size_t hyx::Course::add_grades(const std::vector<Grade_entry>& grades) noexcept
+{
+    // resolve every entry once; runs of the same category reuse the previous lookup.
+    std::vector<Grade_record> records;
+    records.reserve(grades.size());
+
+    std::string_view last_name;
+    Category_id last_id;
+
+    for (std::size_t i = 0; i < grades.size(); ++i)
+    {
+        if (i == 0 || grades[i].category != last_name)
+        {
+            last_name = grades[i].category;
+            last_id = this->get_category(std::string(last_name));
+        }
+
+        records.push_back({ last_id, grades[i].earned, grades[i].possible });
+    }
+
+    return this->add_grades(records);
+}
+
+void hyx::Course::add_extra_to_total(double extra)
+{
+    this->extra_ += extra;
+
+    this->update_grade();
+}
+
+bool hyx::Course::recompute() noexcept
+{
+    for (std::uint32_t id = 0; id < this->points_.size(); ++id)
+    {
+        this->update_category(Category_id(id));
+    }
+
+    return this->update_grade();
+}
+
+bool hyx::Course::project_grade(const std::vector<Grade_record>& grades, double& grade) const
+{
+    Projection_buffers buffers;
+
+    return this->project_grade(grades, grade, buffers);
+}
+
+bool hyx::Course::project_grade(const std::vector<Grade_record>& grades, double& grade, Projection_buffers& buffers) const
+{
+    if (this->is_withdrawn() || this->is_replaced() || not (this->has_good_weights() || this->is_point_based()))
+    {
+        return false;
+    }
+
+    std::size_t size = this->points_.size();
+    std::vector<std::size_t>& counts = buffers.counts;
+
+    counts.assign(size, 0);
+
+    for (const auto& record : grades)
+    {
+        if (record.category && record.category.index() < size)
+        {
+            ++counts[record.category.index()];
+        }
+    }
+
+    // the course's own totals, extended as add_grades would extend them.
+    std::vector<double>& kept_earned = buffers.kept_earned;
+    std::vector<double>& kept_possible = buffers.kept_possible;
+    std::vector<bool>& has_kept = buffers.has_kept;
+
+    kept_earned.resize(size);
+    kept_possible.resize(size);
+    has_kept.resize(size);
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        kept_earned[i] = this->points_[i]->kept_earned;
+        kept_possible[i] = this->points_[i]->kept_possible;
+        has_kept[i] = this->points_[i]->has_kept;
+    }
+
+    for (const auto& record : grades)
+    {
+        if (record.category && record.category.index() < size)
+        {
+            const Category& category = *this->points_[record.category.index()];
+
+            if (category.drops <= 0 && category.replace.first <= 0)
+            {
+                kept_earned[record.category.index()] += record.earned;
+                kept_possible[record.category.index()] += record.possible;
+                has_kept[record.category.index()] = true;
+            }
+        }
+    }
+
+    // grades of one category, the ones it has followed by the new ones.
+    std::vector<double>& earned = buffers.earned;
+    std::vector<double>& possible = buffers.possible;
+    std::vector<std::size_t>& lowest = buffers.lowest;
+
+    auto gather = [&](std::uint32_t id) {
+        const double* old_earned = this->scores_.earned(id);
+        const double* old_possible = this->scores_.possible(id);
+
+        earned.assign(old_earned, old_earned + this->scores_.size(id));
+        possible.assign(old_possible, old_possible + this->scores_.size(id));
+
+        for (const auto& record : grades)
+        {
+            if (record.category.index() == id)
+            {
+                earned.push_back(record.earned);
+                possible.push_back(record.possible);
+            }
+        }
+    };
+
+    for (std::uint32_t id = 0; id < size; ++id)
+    {
+        const Category& category = *this->points_[id];
+
+        if (category.drops <= 0 && category.replace.first <= 0)
+        {
+            continue;
+        }
+
+        bool has_replacement = category.replace.first > 0 && category.replace_id;
+        std::uint32_t source = category.replace_id.index();
+
+        // a category is settled again when it gains grades, or when the category it replaces from gains its first one.
+        if (counts[id] == 0 && not (has_replacement && counts[source] != 0 && this->scores_.size(source) == 0))
+        {
+            continue;
+        }
+
+        double first_grade[2] = { 0.0, 0.0 };
+        const double* replacement = nullptr;
+
+        if (has_replacement && this->scores_.size(source) != 0)
+        {
+            first_grade[0] = this->scores_.earned(source)[0];
+            first_grade[1] = this->scores_.possible(source)[0];
+            replacement = first_grade;
+        }
+        else if (has_replacement && counts[source] != 0)
+        {
+            for (const auto& record : grades)
+            {
+                if (record.category.index() == source)
+                {
+                    first_grade[0] = record.earned;
+                    first_grade[1] = record.possible;
+                    replacement = first_grade;
+
+                    break;
+                }
+            }
+        }
+
+        gather(id);
+
+        std::size_t window = std::min(earned.size(),
+            static_cast<std::size_t>(std::max(category.drops, 0)) + static_cast<std::size_t>(std::max(category.replace.first, 0)));
+
+        select_lowest(earned.data(), possible.data(), earned.size(), window, buffers.percents, buffers.order, lowest);
+
+        bool kept = false;
+
+        sum_kept(earned.data(), possible.data(), earned.size(), lowest, category.drops, replacement, buffers.marked, kept_earned[id], kept_possible[id], kept);
+        has_kept[id] = kept;
+    }
+
+    // combined the same way update_grade combines them.
+    double final_grade = 0.0f;
+    double unused_weight = 0.0f;
+    double total_earned_points = 0.0f;
+    double total_possible_points = 0.0f;
+    bool has_grades = false;
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        has_grades = has_grades || has_kept[i];
+
+        if (not has_kept[i])
+        {
+            unused_weight += this->points_[i]->weight;
+        }
+        else if (this->is_point_based())
+        {
+            total_earned_points += kept_earned[i];
+            total_possible_points += kept_possible[i];
+        }
+        else
+        {
+            final_grade += this->points_[i]->weight * (kept_earned[i] / kept_possible[i]);
+        }
+    }
+
+    if (not has_grades)
+    {
+        return false;
+    }
+
+    grade = (this->is_point_based()) ? ((total_earned_points + this->extra_) / total_possible_points) * 100 : final_grade * 100 / (1 - unused_weight) + this->extra_;
+
+    return true;
+}
+
+double hyx::Course::what_if(const std::vector<Grade_record>& grades) const
+{
+    double grade = this->grade_;
+
+    this->project_grade(grades, grade);
+
+    return grade;
+}
+
+hyx::Course::Required_score hyx::Course::required_score(std::string_view letter, const std::vector<Planned_grade>& planned) const
+{
+    const Compiled_scale& scale = *this->scale_;
+    std::size_t band = 0;
+
+    while (band < scale.size() && scale.get_letter(static_cast<std::uint8_t>(band)) != letter)
+    {
+        ++band;
+    }
+
+    if (band == scale.size())
+    {
+        return { false, 0.0, this->grade_ };
+    }
+
+    // bands run from the highest down and find() floors the grade, so reaching the low end of the band is enough.
+    double target = scale.get_band(static_cast<std::uint8_t>(band)).low;
+
+    // scaled to base points the bands can leave whole grades between them, so aim for the least whole grade that lands in
+    // the band or a better one.
+    if (this->is_point_based())
+    {
+        target = std::numeric_limits<double>::infinity();
+
+        for (std::size_t better = 0; better <= band; ++better)
+        {
+            // the least whole grade whose points reach the low end, as find() works it out.
+            double low = scale.get_band(static_cast<std::uint8_t>(better)).low * 100.0;
+            double least = std::ceil(low / this->base_points_);
+
+            least += (least * this->base_points_ < low) ? 1 : 0;
+
+            std::uint8_t found = scale.find(least, this->base_points_);
+
+            if (found != Compiled_scale::npos && found <= band)
+            {
+                target = std::min(target, least);
+            }
+        }
+
+        if (target == std::numeric_limits<double>::infinity())
+        {
+            return { false, 0.0, this->grade_ };
+        }
+    }
+
+    std::vector<Grade_record> records;
+    std::vector<bool> is_planned(this->points_.size(), false);
+    bool linear = true;
+
+    records.reserve(planned.size());
+
+    for (const auto& grade : planned)
+    {
+        if (grade.category && grade.category.index() < this->points_.size() && grade.possible > 0)
+        {
+            const Category& category = *this->points_[grade.category.index()];
+
+            records.push_back({ grade.category, 0.0, grade.possible });
+            is_planned[grade.category.index()] = true;
+            linear = linear && category.drops <= 0 && category.replace.first <= 0;
+        }
+    }
+
+    // a planned grade that becomes the first of its category also sets what other categories replace with.
+    for (const auto& category : this->points_)
+    {
+        if (category->replace.first > 0 && category->replace_id && is_planned[category->replace_id.index()] && this->scores_.size(category->replace_id.index()) == 0)
+        {
+            linear = false;
+        }
+    }
+
+    // fractions are counted in whole steps, so fraction * possible is exact and every planned grade scores exactly the same
+    // share; otherwise rounding would order equal planned grades differently from one fraction to the next.
+    constexpr std::uint64_t steps = std::uint64_t{ 1 } << 32;
+    Projection_buffers buffers;
+
+    auto grade_at = [&](std::uint64_t step, double& grade) {
+        for (auto& record : records)
+        {
+            record.earned = (step * Required_score::step) * record.possible;
+        }
+
+        return this->project_grade(records, grade, buffers);
+    };
+
+    double low_grade = 0.0;
+    double high_grade = 0.0;
+
+    if (not grade_at(0, low_grade) || not grade_at(steps, high_grade))
+    {
+        return { false, 0.0, this->grade_ };
+    }
+
+    if (low_grade >= target)
+    {
+        return { true, 0.0, low_grade };
+    }
+
+    // low_step falls short of target and high_step reaches it, with the grade rising between them.
+    std::uint64_t low_step = 0;
+    std::uint64_t high_step = steps;
+
+    if (linear)
+    {
+        // written so a grade that is not a number never reaches the target.
+        if (not (high_grade >= target))
+        {
+            return { false, 1.0, high_grade };
+        }
+
+        double fraction = (target - low_grade) / (high_grade - low_grade);
+        std::uint64_t step = std::min(steps, std::max(std::uint64_t{ 1 }, static_cast<std::uint64_t>(std::ceil(fraction * steps))));
+        double grade = 0.0;
+        double next = 0.0;
+
+        // usually right on or a step off from rounding; anything further is finished by bisection.
+        grade_at(step, grade);
+
+        if (grade >= target)
+        {
+            grade_at(step - 1, next);
+            high_step = (next >= target) ? step - 1 : step;
+            high_grade = (next >= target) ? next : grade;
+            low_step = (next >= target) ? 0 : step - 1;
+        }
+        else
+        {
+            grade_at(step + 1, next);
+            low_step = (next >= target) ? step : step + 1;
+            high_grade = (next >= target) ? next : high_grade;
+            high_step = (next >= target) ? step + 1 : steps;
+        }
+    }
+    else
+    {
+        // drops and replacements only change which grades count where the planned share passes the share of a grade already
+        // given. between two such shares the grade only rises, but at one it can fall, so full marks may miss a letter a lower
+        // score earns. the answer lies in the first stretch that reaches target, so look at the top of each stretch in turn.
+        std::vector<std::uint64_t> shares;
+
+        for (std::uint32_t i = 0; i < this->points_.size(); ++i)
+        {
+            for (std::size_t j = 0; j < this->scores_.size(i); ++j)
+            {
+                double share = this->scores_.earned(i)[j] / this->scores_.possible(i)[j];
+
+                // the first step at or above the share.
+                if (share > 0 && share < 1)
+                {
+                    shares.push_back(static_cast<std::uint64_t>(std::ceil(share * steps)));
+                }
+            }
+        }
+
+        shares.push_back(steps);
+        std::sort(shares.begin(), shares.end());
+        shares.erase(std::unique(shares.begin(), shares.end()), shares.end());
+
+        bool found = false;
+
+        for (std::size_t i = 0; i < shares.size() && not found; ++i)
+        {
+            // the top of the stretch just below the share, then the share itself.
+            for (std::uint64_t step : { shares[i] - 1, shares[i] })
+            {
+                double grade = 0.0;
+
+                if (step <= low_step)
+                {
+                    continue;
+                }
+
+                grade_at(step, grade);
+
+                if (grade >= target)
+                {
+                    high_step = step;
+                    high_grade = grade;
+                    found = true;
+
+                    break;
+                }
+
+                low_step = step;
+            }
+        }
+
+        if (not found)
+        {
+            return { false, 1.0, high_grade };
+        }
+    }
+
+    while (high_step - low_step > 1)
+    {
+        std::uint64_t step = low_step + (high_step - low_step) / 2;
+        double grade = 0.0;
+
+        grade_at(step, grade);
+
+        if (grade >= target)
+        {
+            high_step = step;
+            high_grade = grade;
+        }
+        else
+        {
+            low_step = step;
+        }
+    }
+
+    return { true, high_step * Required_score::step, high_grade };
+}
+
+void hyx::Course::render_header(std::string& out) const noexcept
+{
+    out.append("Course Name: ").append(this->info_->name)
+        .append("\nInstitution: ").append(this->info_->institution)
+        .append("\nDetails: ").append(this->info_->details)
+        .append("\nCRN: ");
+    append_integer(out, this->crn_);
+    out.append("\nDays: ");
+    hyx::schedule::append_week_days(out, this->schedule_.week_days);
+    out.push_back('\n');
+}
+
+void hyx::Course::render_grades(std::string& out, bool percent_sign) const noexcept
+{
+    out.append("Grade: ");
+
+    if (this->grade_ == -1)
+    {
+        out.append("N/A");
+    }
+    else
+    {
+        append_decimal(out, this->grade_, std::chars_format::fixed, 6);
+
+        if (percent_sign)
+        {
+            out.push_back('%');
+        }
+    }
+
+    const std::string& letter = this->get_letter();
+
+    out.append("\nLetter: ").append((letter.empty()) ? "N/A" : letter)
+        .append("\nCredit Hours: ");
+    append_integer(out, this->units_);
+    out.append("\nGrade Points: ");
+
+    if (this->grade_points_ == -1)
+    {
+        out.append("N/A");
+    }
+    else
+    {
+        append_decimal(out, this->grade_points_, std::chars_format::fixed, 6);
+    }
+
+    out.append("\nBook(s):");
+
+    for (const auto& book : this->info_->books)
+    {
+        out.append("\n ").append(book);
+    }
+
+    out.append("\nPoints:");
+
+    std::size_t name_width = (this->extra_ != 0) ? std::string_view("EXTRA").size() : 0;
+
+    for (const auto& itr : this->points_)
+    {
+        name_width = std::max(name_width, itr->name.size());
+    }
+
+    for (std::uint32_t id = 0; id < this->points_.size(); ++id)
+    {
+        const Category& category = *this->points_[id];
+
+        if (category.name == "")
+        {
+            continue;
+        }
+
+        out.append("\n ");
+
+        std::size_t start = out.size();
+
+        out.append(category.name);
+        append_padding(out, start, name_width + 2);
+        out.push_back('[');
+
+        // weights have always gone through to_string first, so they round to 6 decimals before the 4 significant digits.
+        char buff[384];
+        double weight = category.weight;
+
+        std::from_chars(buff, std::to_chars(buff, buff + sizeof(buff), weight, std::chars_format::fixed, 6).ptr, weight);
+
+        start = out.size();
+        append_decimal(out, weight, std::chars_format::general, 4);
+        append_padding(out, start, 7);
+        out.append("weight | ");
+
+        start = out.size();
+        append_integer(out, category.drops);
+        append_padding(out, start, 3);
+        out.append(" drops]  ");
+
+        const double* earned = this->scores_.earned(id);
+        const double* possible = this->scores_.possible(id);
+        std::size_t count = this->scores_.size(id);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (i != 0)
+            {
+                out.append(", ");
+            }
+
+            append_decimal(out, earned[i], std::chars_format::general, 6);
+            out.push_back('/');
+            append_decimal(out, possible[i], std::chars_format::general, 6);
+        }
+    }
+
+    if (this->extra_ != 0)
+    {
+        out.append("\n ");
+
+        std::size_t start = out.size();
+
+        out.append("EXTRA");
+        append_padding(out, start, name_width + 2);
+        out.append("[N/A    weight | N/A drops]  ");
+        append_decimal(out, this->extra_, std::chars_format::fixed, 6);
+
+        if (not this->is_point_based())
+        {
+            out.push_back('%');
+        }
+    }
+
+    out.push_back('\n');
+}
+
+void hyx::Course::render(std::string& out) const noexcept
+{
+    this->render_header(out);
+
+    out.append("Time: ");
+    hyx::schedule::append_clock_time(out, this->schedule_.start_minute);
+    out.append(" - ");
+    hyx::schedule::append_clock_time(out, this->schedule_.end_minute);
+    out.append("\nDate: ");
+    hyx::schedule::append_ISO_date(out, this->schedule_.start_day);
+    out.append(" -- ");
+    hyx::schedule::append_ISO_date(out, this->schedule_.end_day);
+    out.append("\nLocation: ").append(this->info_->location)
+        .append("\nInstructor: ").append(this->info_->instructor)
+        .push_back('\n');
+
+    this->render_grades(out, true);
+}
+
+hyx::CourseWLAB::CourseWLAB(
+    std::string name,
+    long crn,
+    int units,
+    Shared_scale scale,
+    std::string institution,
+    std::string location,
+    std::string lab_location,
+    std::string instructor,
+    std::string details,
+    std::array<bool, 8> week_days,
+    std::array<bool, 8> lab_week_days,
+    std::array<int, 3> start_date,
+    std::array<int, 3> end_date,
+    std::array<int, 3> lab_start_date,
+    std::array<int, 3> lab_end_date,
+    std::array<int, 2> start_time,
+    std::array<int, 2> end_time,
+    std::array<int, 2> lab_start_time,
+    std::array<int, 2> lab_end_time
+) :
+    Course(
+        name,
+        crn,
+        units,
+        scale,
+        institution,
+        location,
+        instructor,
+        details,
+        week_days,
+        start_date,
+        end_date,
+        start_time,
+        end_time),
+    lab_location_(std::make_shared<const std::string>(lab_location)),
+    lab_schedule_(Schedule::pack(lab_week_days, lab_start_date, lab_end_date, lab_start_time, lab_end_time))
+{
+}
 
 const std::string& hyx::CourseWLAB::get_lab_location() const noexcept
 {
-    return this->lab_location_;
+    return *this->lab_location_;
 }
 
 const std::string hyx::CourseWLAB::get_lab_week_days() const noexcept
 {
-    return week_day_helper(this->lab_week_days_);
+    std::string str_week_days;
+
+    hyx::schedule::append_week_days(str_week_days, this->lab_schedule_.week_days);
+
+    return str_week_days;
 }
 
 const std::tm hyx::CourseWLAB::get_lab_start_date() const noexcept
 {
-    std::tm date{};
-    date.tm_year = this->lab_start_datetime_[0] - 1900;
-    date.tm_mon = this->lab_start_datetime_[1] - 1;
-    date.tm_mday = this->lab_start_datetime_[2];
-
-    return date;
+    return to_tm_date(this->lab_schedule_.start_day);
 }
 
 const std::tm hyx::CourseWLAB::get_lab_end_date() const noexcept
 {
-    std::tm date{};
-    date.tm_year = this->lab_end_datetime_[0] - 1900;
-    date.tm_mon = this->lab_end_datetime_[1] - 1;
-    date.tm_mday = this->lab_end_datetime_[2];
-
-    return date;
+    return to_tm_date(this->lab_schedule_.end_day);
 }
 
 const std::tm hyx::CourseWLAB::get_lab_start_time() const noexcept
 {
-    std::tm time{};
-    time.tm_hour = this->lab_start_datetime_[3];
-    time.tm_min = this->lab_start_datetime_[4];
-
-    return time;
+    return to_tm_time(this->lab_schedule_.start_minute);
 }
 
 const std::tm hyx::CourseWLAB::get_lab_end_time() const noexcept
 {
-    std::tm time{};
-    time.tm_hour = this->lab_end_datetime_[3];
-    time.tm_min = this->lab_end_datetime_[4];
+    return to_tm_time(this->lab_schedule_.end_minute);
+}
+
+const hyx::Schedule& hyx::CourseWLAB::get_lab_schedule() const noexcept
+{
+    return this->lab_schedule_;
+}
 
-    return time;
+void hyx::CourseWLAB::render(std::string& out) const noexcept
+{
+    this->render_header(out);
+
+    out.append("Lab Days: ");
+    hyx::schedule::append_week_days(out, this->lab_schedule_.week_days);
+    out.append("\nTime: ");
+    hyx::schedule::append_clock_time(out, this->get_schedule().start_minute);
+    out.append(" - ");
+    hyx::schedule::append_clock_time(out, this->get_schedule().end_minute);
+    out.append("\nDate: ");
+    hyx::schedule::append_ISO_date(out, this->get_schedule().start_day);
+    out.append(" - ");
+    hyx::schedule::append_ISO_date(out, this->get_schedule().end_day);
+    out.append("\nLab Time: ");
+    hyx::schedule::append_clock_time(out, this->lab_schedule_.start_minute);
+    out.append(" - ");
+    hyx::schedule::append_clock_time(out, this->lab_schedule_.end_minute);
+    out.append("\nLab Date: ");
+    hyx::schedule::append_ISO_date(out, this->lab_schedule_.start_day);
+    out.append(" - ");
+    hyx::schedule::append_ISO_date(out, this->lab_schedule_.end_day);
+    out.append("\nLocation: ").append(this->get_location())
+        .append("\nLab Location: ").append(this->get_location())
+        .append("\nInstructor: ").append(this->get_instructor())
+        .push_back('\n');
+
+    this->render_grades(out, false);
+}
+
+void hyx::recompute_all(std::vector<hyx::Course>& courses, unsigned int threads)
+{
+    hyx::parallel_for(courses.size(), threads, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i)
+        {
+            courses[i].recompute();
+        }
+        }, 64);
+}
+
+void hyx::recompute_all(const std::vector<hyx::Course*>& courses, unsigned int threads)
+{
+    hyx::parallel_for(courses.size(), threads, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i)
+        {
+            courses[i]->recompute();
+        }
+        }, 64);
+}
+
+hyx::GPA_accumulator::GPA_accumulator() noexcept :
+    grade_points_(0),
+    units_(0)
+{
+}
+
+double hyx::GPA_accumulator::get_grade_points() const noexcept
+{
+    return this->grade_points_;
+}
+
+double hyx::GPA_accumulator::get_units() const noexcept
+{
+    return this->units_;
+}
+
+float hyx::GPA_accumulator::get_GPA() const noexcept
+{
+    return static_cast<float>(this->grade_points_ / this->units_);
+}
+
+void hyx::GPA_accumulator::add(const hyx::Course& course) noexcept
+{
+    if (course.is_included_in_gpa())
+    {
+        this->grade_points_ += course.get_grade_points();
+        this->units_ += course.get_units();
+    }
+}
+
+void hyx::GPA_accumulator::add(const hyx::Course* course) noexcept
+{
+    this->add(*course);
+}
+
+void hyx::GPA_accumulator::merge(const GPA_accumulator& other) noexcept
+{
+    this->grade_points_ += other.grade_points_;
+    this->units_ += other.units_;
 }
 
 float hyx::get_GPA(const std::vector<hyx::Course>& courses) noexcept
 {
-    return std::accumulate(courses.begin(), courses.end(), 0.0f, [](float sum, const hyx::Course &crs) { return (crs.is_included_in_gpa()) ? sum + crs.get_grade_points() : sum; })
-    / std::accumulate(courses.begin(), courses.end(), 0.0f, [](float sum, const hyx::Course &crs) { return (crs.is_included_in_gpa()) ? sum + crs.get_units() : sum; });
+    return hyx::accumulate_GPA(courses).get_GPA();
 }
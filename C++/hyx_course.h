@@ -7,123 +7,217 @@
 #ifndef HYX_COURSE_H
 #define HYX_COURSE_H
 
+#include <algorithm> // min
 #include <array> // array
-#include <climits> // INT_MAX
+#include <climits> // UINT32_MAX
+#include <cstddef> // size_t
+#include <cstdint> // uint32_t
 #include <ctime> // tm
+#include <iterator> // begin, end, distance, iterator_traits
+#include <memory> // shared_ptr
 #include <ostream> // ostream
 #include <string> // string
-#include <tuple> // tuple
+#include <string_view> // string_view
+#include <type_traits> // is_base_of_v
 #include <unordered_map> // unordered_map
 #include <utility> // pair
 #include <vector> // vector
 
+#include "hyx_cow.h"
+#include "hyx_gradebook.h"
+#include "hyx_parallel.h"
+#include "hyx_scale.h"
+#include "hyx_schedule.h"
+
 
 namespace hyx
 {
-    typedef std::unordered_map<std::string, std::pair<int, int>> Grade_scale;
+    enum class Course_status : std::uint8_t
+    {
+        active,
+        withdrawn,
+        replaced,
+        incomplete
+    };
 
-    namespace scale
+    // index of a category within one course.
+    class Category_id
     {
-        inline Grade_scale STD({
-            {"A", {90, INT_MAX}},
-            {"B", {80, 89}},
-            {"C", {70, 79}},
-            {"D", {60, 69}},
-            {"F", {0, 59}}
-            });
-
-        inline Grade_scale G11({
-            {"A", {90, INT_MAX}},
-            {"A-", {85, 89}},
-            {"B+", {80, 84}},
-            {"B", {75, 79}},
-            {"B-", {70, 74}},
-            {"C+", {67, 69}},
-            {"C", {64, 66}},
-            {"C-", {60, 63}},
-            {"D+", {57, 59}},
-            {"D", {54, 56}},
-            {"D-", {50, 53}},
-            {"F", {0, 49}}
-            });
-
-        inline Grade_scale U12({
-            {"A", {93, INT_MAX}},
-            {"A-", {90, 92}},
-            {"B+", {87, 89}},
-            {"B", {83, 86}},
-            {"B-", {80, 82}},
-            {"C+", {77, 79}},
-            {"C", {73, 76}},
-            {"C-", {70, 72}},
-            {"D", {60, 69}},
-            {"F", {0, 59}}
-            });
-
-        inline Grade_scale U11({
-            {"A", {93, INT_MAX}},
-            {"A-", {90, 92}},
-            {"B+", {87, 89}},
-            {"B", {83, 86}},
-            {"B-", {80, 82}},
-            {"C+", {77, 79}},
-            {"C", {73, 76}},
-            {"C-", {70, 72}},
-            {"D+", {67, 69}},
-            {"D", {63, 66}},
-            {"D-", {60, 62}},
-            {"F", {0, 59}}
-            });
-
-        inline Grade_scale PF({
-            {"P", {60, INT_MAX}},
-            {"NP", {0, 59}}
-            });
-    }
+    private:
+
+        static constexpr std::uint32_t npos = UINT32_MAX;
+
+        std::uint32_t index_;
+
+    public:
+
+        constexpr Category_id() noexcept : index_(npos) {}
+
+        constexpr explicit Category_id(std::uint32_t index) noexcept : index_(index) {}
+
+        [[nodiscard]] constexpr std::uint32_t index() const noexcept { return this->index_; }
+
+        constexpr explicit operator bool() const noexcept { return this->index_ != npos; }
+
+        friend constexpr bool operator==(Category_id lhs, Category_id rhs) noexcept { return lhs.index_ == rhs.index_; }
+
+        friend constexpr bool operator!=(Category_id lhs, Category_id rhs) noexcept { return lhs.index_ != rhs.index_; }
+    };
 
     class Course
     {
     public:
-        // name; earned points, possible points, weight, drops, (replacements, name to replace with)
-        typedef std::unordered_map<std::string, std::tuple<std::vector<double>, std::vector<double>, double, int, std::pair<int, std::string>>> Grade_container;
+        // name, weight, drops, (replacements, name to replace with); the scores live in the gradebook.
+        struct Category
+        {
+            std::string name;
+            double weight;
+            int drops;
+            std::pair<int, std::string> replace;
+
+            // resolved once the category named in replace exists.
+            Category_id replace_id;
+
+            // indices of the (drops + replacements) lowest grades, ordered by percentage.
+            std::vector<std::size_t> lowest;
+
+            // running totals of the grades that still count after drops and replacements.
+            double kept_earned;
+            double kept_possible;
+            bool has_kept;
+        };
+
+        // indexed by Category_id; copies of a course share each category until one of them changes it.
+        typedef std::vector<Cow<Category>> Grade_container;
+
+        // the text of a course, shared by its copies; it only changes when a book is added.
+        struct Info
+        {
+            std::string name;
+            std::string institution;
+            std::string location;
+            std::string instructor;
+            std::string details;
+            std::vector<std::string> books;
+        };
+
+        // category name, earned points, possible points
+        struct Grade_entry
+        {
+            std::string_view category;
+            double earned;
+            double possible;
+        };
+
+        // category, earned points, possible points
+        struct Grade_record
+        {
+            Category_id category;
+            double earned;
+            double possible;
+        };
+
+        // a grade that has not been given yet: category, possible points
+        struct Planned_grade
+        {
+            Category_id category;
+            double possible;
+        };
+
+        // the least share of the possible points, scored on every planned grade, that earns a letter.
+        struct Required_score
+        {
+            // false if the letter is not on the scale, the course would have no grade, or full marks still fall short.
+            bool reachable;
+
+            // fractions are whole multiples of step, fine enough that every planned score is exact.
+            static constexpr double step = 1.0 / 4294967296.0;
+
+            // from 0 to 1; 0 when the letter is earned even with nothing scored.
+            double fraction;
+
+            // the grade the course ends with at that fraction.
+            double grade;
+        };
 
     private:
 
-        std::string name_;
+        // snapshots, the JSON writer and projections read the whole state directly.
+        friend class Snapshot;
+        friend class Course_view;
+        friend class Course_json;
+        friend class Grade_projector;
+
+        Cow<Info> info_;
         long crn_;
         int units_;
-        Grade_scale scale_;
-        std::string institution_;
-        std::string location_;
-        std::string instructor_;
-        std::string details_;
-        std::array<bool, 8> week_days_;
-        std::array<int, 5> start_datetime_;
-        std::array<int, 5> end_datetime_;
-
-        std::vector<std::string> books_;
+        Shared_scale scale_;
+        Schedule schedule_;
+
         double grade_;
-        std::string letter_;
+        Course_status status_;
+        std::uint8_t band_;
         float grade_points_;
         Grade_container points_;
+        Cow<std::unordered_map<std::string, Category_id>> category_ids_;
+        Gradebook scores_;
         double extra_;
         double base_points_;
 
+        // the category, copied first if another course still shares it.
+        Category& writable_category(Category_id id);
+
         void update_letter() noexcept;
 
         void update_grade_points() noexcept;
 
-        bool has_good_weights() noexcept;
+        bool has_good_weights() const noexcept;
+
+        void update_category(Category_id id) noexcept;
+
+        void update_kept(Category_id id) noexcept;
+
+        void add_to_category(Category_id id, double earn, double poss) noexcept;
+
+        void update_dependents(Category_id id) noexcept;
 
         bool update_grade() noexcept;
 
+        // working space for project_grade, kept by a caller that projects many times so the vectors are only grown once.
+        struct Projection_buffers
+        {
+            std::vector<std::size_t> counts;
+            std::vector<double> kept_earned;
+            std::vector<double> kept_possible;
+            std::vector<bool> has_kept;
+            std::vector<double> earned;
+            std::vector<double> possible;
+            std::vector<double> percents;
+            std::vector<std::size_t> order;
+            std::vector<std::size_t> lowest;
+            std::vector<std::pair<std::size_t, bool>> marked;
+        };
+
+        // the grade after add_grades(grades), without changing anything; false if the course would have none.
+        bool project_grade(const std::vector<Grade_record>& grades, double& grade) const;
+
+        bool project_grade(const std::vector<Grade_record>& grades, double& grade, Projection_buffers& buffers) const;
+
+    protected:
+
+        // name through days of the report.
+        void render_header(std::string& out) const noexcept;
+
+        // grade through points of the report.
+        void render_grades(std::string& out, bool percent_sign) const noexcept;
+
     public:
 
         Course(
             std::string name,
             long crn,
             int units,
-            Grade_scale scale,
+            Shared_scale scale,
             std::string institution,
             std::string location,
             std::string instructor,
@@ -135,6 +229,17 @@ namespace hyx
             std::array<int, 2> end_time = { -1, -1 }
         );
 
+        // a copy shares the text, categories and scores of other, and whichever side changes a category or its scores first copies just that one.
+        Course(const Course& other) = default;
+
+        Course(Course&& other) = default;
+
+        Course& operator=(const Course& other) = default;
+
+        Course& operator=(Course&& other) = default;
+
+        virtual ~Course() = default;
+
         [[nodiscard]] const std::string& get_name() const noexcept;
 
         [[nodiscard]] long get_crn() const noexcept;
@@ -161,11 +266,17 @@ namespace hyx
 
         [[nodiscard]] const std::tm get_end_time() const noexcept;
 
+        // the days, dates and times above without unpacking them.
+        [[nodiscard]] const Schedule& get_schedule() const noexcept;
+
         [[nodiscard]] const std::vector<std::string>& get_books() const noexcept;
 
         [[nodiscard]] double get_grade() const noexcept;
 
-        [[nodiscard]] const std::string get_letter() const noexcept;
+        // "W", "R" or "I" for those statuses, otherwise the letter of the current band ("" if none).
+        [[nodiscard]] const std::string& get_letter() const noexcept;
+
+        [[nodiscard]] Course_status get_status() const noexcept;
 
         [[nodiscard]] float get_grade_points() const noexcept;
 
@@ -197,12 +308,33 @@ namespace hyx
 
         bool add_book(std::string book) noexcept;
 
-        bool add_category(std::string name, double weight = 0, int drop = 0, std::pair<int, std::string> replace = { 0, "" });
+        [[nodiscard]] Category_id get_category(std::string name) const noexcept;
+
+        Category_id add_category(std::string name, double weight = 0, int drop = 0, std::pair<int, std::string> replace = { 0, "" });
     
+        bool add_grade(Category_id id, double earn, double poss) noexcept;
+
         bool add_grade(std::string name, double earn, double poss) noexcept;
 
+        std::size_t add_grades(const std::vector<Grade_record>& grades) noexcept;
+
+        std::size_t add_grades(const std::vector<Grade_entry>& grades) noexcept;
+
         void add_extra_to_total(double extra);
 
+        bool recompute() noexcept;
+
+        // the grade the course would have after add_grades(grades); the course itself is left as it is.
+        [[nodiscard]] double what_if(const std::vector<Grade_record>& grades) const;
+
+        // the score needed on every planned grade to finish with letter or better, without changing the course.
+        // solved directly when the planned grades add linearly; with drops and replacements the grade can fall as the score rises,
+        // so the stretches between the shares of grades already given are searched in turn.
+        [[nodiscard]] Required_score required_score(std::string_view letter, const std::vector<Planned_grade>& planned) const;
+
+        // appends the report that operator<< prints to out, without building any temporary strings.
+        virtual void render(std::string& out) const noexcept;
+
     };
 
     class CourseWLAB
@@ -210,10 +342,12 @@ namespace hyx
     {
     private:
 
-        std::string lab_location_;
-        std::array<bool, 8> lab_week_days_;
-        std::array<int, 5> lab_start_datetime_;
-        std::array<int, 5> lab_end_datetime_;
+        friend class Snapshot;
+        friend class Course_view;
+        friend class Course_json;
+
+        std::shared_ptr<const std::string> lab_location_;
+        Schedule lab_schedule_;
 
     public:
 
@@ -221,7 +355,7 @@ namespace hyx
             std::string name,
             long crn,
             int units,
-            Grade_scale scale,
+            Shared_scale scale,
             std::string institution,
             std::string location,
             std::string lab_location,
@@ -251,11 +385,93 @@ namespace hyx
 
         [[nodiscard]] const std::tm get_lab_end_time() const noexcept;
 
+        [[nodiscard]] const Schedule& get_lab_schedule() const noexcept;
+
+        void render(std::string& out) const noexcept override;
+
+    };
+
+    // grade points and units of the courses that count toward a GPA; accumulators for separate terms or shards can be merged.
+    class GPA_accumulator
+    {
+    private:
+
+        double grade_points_;
+        double units_;
+
+    public:
+
+        GPA_accumulator() noexcept;
+
+        [[nodiscard]] double get_grade_points() const noexcept;
+
+        [[nodiscard]] double get_units() const noexcept;
+
+        [[nodiscard]] float get_GPA() const noexcept;
+
+        void add(const hyx::Course& course) noexcept;
+
+        void add(const hyx::Course* course) noexcept;
+
+        void merge(const GPA_accumulator& other) noexcept;
+
     };
 
+    // one pass over any range of courses or course pointers; only random access ranges are split across threads.
+    template <class Range>
+    [[nodiscard]] GPA_accumulator accumulate_GPA(const Range& courses, unsigned int threads = 1)
+    {
+        GPA_accumulator total;
+
+        auto first = std::begin(courses);
+        typedef typename std::iterator_traits<decltype(first)>::iterator_category Category;
+
+        if constexpr (std::is_base_of_v<std::random_access_iterator_tag, Category>)
+        {
+            if (threads != 1)
+            {
+                constexpr std::size_t grain = 4096;
+
+                std::size_t count = static_cast<std::size_t>(std::distance(first, std::end(courses)));
+
+                // one partial sum per chunk, merged in order so the result does not depend on scheduling.
+                std::vector<GPA_accumulator> partials((count + grain - 1) / grain);
+
+                hyx::parallel_for(partials.size(), threads, [&](std::size_t first_chunk, std::size_t last_chunk) {
+                    for (std::size_t chunk = first_chunk; chunk < last_chunk; ++chunk)
+                    {
+                        auto last = first + std::min(count, (chunk + 1) * grain);
+
+                        for (auto itr = first + chunk * grain; itr != last; ++itr)
+                        {
+                            partials[chunk].add(*itr);
+                        }
+                    }
+                    });
+
+                for (const auto& partial : partials)
+                {
+                    total.merge(partial);
+                }
+
+                return total;
+            }
+        }
+
+        for (const auto& course : courses)
+        {
+            total.add(course);
+        }
+
+        return total;
+    }
+
     [[nodiscard]] float get_GPA(const std::vector<hyx::Course>& courses) noexcept;
 
-    std::ostream& operator<< (std::ostream& os, const hyx::Grade_scale& scale) noexcept;
+    // recompute every course on up to threads threads (0 uses every core).
+    void recompute_all(std::vector<hyx::Course>& courses, unsigned int threads = 0);
+
+    void recompute_all(const std::vector<hyx::Course*>& courses, unsigned int threads = 0);
 
     std::ostream& operator<< (std::ostream& os, const hyx::Course& course) noexcept;
 
@@ -0,0 +1,103 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#ifndef HYX_COW_H
+#define HYX_COW_H
+
+#include <atomic> // atomic, memory_order
+#include <memory> // shared_ptr, make_shared
+#include <utility> // move
+
+
+namespace hyx
+{
+    // a value that copies share until one of them writes to it.
+    // both sides of a copy are marked shared for good, so a write never has to guess from use_count whether
+    // another copy, maybe on another thread, is still reading; the worst case is one copy more than needed.
+    template <class T>
+    class Cow
+    {
+    private:
+
+        std::shared_ptr<T> value_;
+        mutable std::atomic<bool> shared_;
+
+    public:
+
+        explicit Cow(T value) :
+            value_(std::make_shared<T>(std::move(value))),
+            shared_(false)
+        {
+        }
+
+        Cow(const Cow& other) :
+            value_(other.value_),
+            shared_(true)
+        {
+            other.shared_.store(true, std::memory_order_release);
+        }
+
+        Cow(Cow&& other) noexcept :
+            value_(std::move(other.value_)),
+            shared_(other.shared_.load(std::memory_order_acquire))
+        {
+        }
+
+        Cow& operator=(const Cow& other)
+        {
+            if (this != &other)
+            {
+                other.shared_.store(true, std::memory_order_release);
+                this->value_ = other.value_;
+                this->shared_.store(true, std::memory_order_relaxed);
+            }
+
+            return *this;
+        }
+
+        Cow& operator=(Cow&& other) noexcept
+        {
+            this->value_ = std::move(other.value_);
+            this->shared_.store(other.shared_.load(std::memory_order_acquire), std::memory_order_relaxed);
+
+            return *this;
+        }
+
+        ~Cow() = default;
+
+        [[nodiscard]] const T& operator*() const noexcept
+        {
+            return *this->value_;
+        }
+
+        [[nodiscard]] const T* operator->() const noexcept
+        {
+            return this->value_.get();
+        }
+
+        // the value, copied first if it was ever shared; afterwards this side owns it alone.
+        [[nodiscard]] T& write()
+        {
+            if (this->shared_.load(std::memory_order_acquire))
+            {
+                this->value_ = std::make_shared<T>(*this->value_);
+                this->shared_.store(false, std::memory_order_relaxed);
+            }
+
+            return *this->value_;
+        }
+
+        // true if a write would copy first.
+        [[nodiscard]] bool is_shared() const noexcept
+        {
+            return this->shared_.load(std::memory_order_acquire);
+        }
+
+    };
+
+} // hyx
+
+#endif // !HYX_COW_H
@@ -0,0 +1,440 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#include "hyx_csv.h"
+
+#include <algorithm> //max
+#include <cerrno> //errno, EINTR
+#include <charconv> //from_chars
+#include <cmath> //isfinite
+#include <cstring> //memchr, memmove
+#include <fcntl.h> //open
+#include <unistd.h> //read, close
+
+namespace
+{
+    constexpr std::size_t batch_size = 4096;
+
+    std::string_view trim(std::string_view text) noexcept
+    {
+        while (not text.empty() && (text.front() == ' ' || text.front() == '\t'))
+        {
+            text.remove_prefix(1);
+        }
+
+        while (not text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r'))
+        {
+            text.remove_suffix(1);
+        }
+
+        return text;
+    }
+
+    // splits off the next field, honouring double quotes with "" for a quote inside them; a field with such a quote is
+    // unescaped into unescaped. returns why the field is malformed, or null.
+    const char* next_field(std::string_view& line, char delimiter, std::string_view& field, std::string& unescaped)
+    {
+        std::size_t start = 0;
+
+        while (start < line.size() && line[start] == ' ')
+        {
+            ++start;
+        }
+
+        if (start < line.size() && line[start] == '"')
+        {
+            std::size_t close = start;
+            bool escaped = false;
+
+            while (true)
+            {
+                close = line.find('"', close + 1);
+
+                if (close == std::string_view::npos)
+                {
+                    return "unterminated quote";
+                }
+
+                if (close + 1 < line.size() && line[close + 1] == '"')
+                {
+                    escaped = true;
+                    ++close;
+                }
+                else
+                {
+                    break;
+                }
+            }
+
+            // only spaces may sit between the closing quote and the delimiter.
+            std::size_t end = close + 1;
+
+            while (end < line.size() && (line[end] == ' ' || line[end] == '\t' || line[end] == '\r'))
+            {
+                ++end;
+            }
+
+            if (end < line.size() && line[end] != delimiter)
+            {
+                return "text after quote";
+            }
+
+            field = line.substr(start + 1, close - start - 1);
+
+            if (escaped)
+            {
+                unescaped.clear();
+
+                for (std::size_t i = 0; i < field.size(); ++i)
+                {
+                    unescaped.push_back(field[i]);
+                    i += (field[i] == '"');
+                }
+
+                field = unescaped;
+            }
+
+            line = (end < line.size()) ? line.substr(end + 1) : std::string_view();
+
+            return nullptr;
+        }
+
+        std::size_t end = line.find(delimiter);
+
+        field = trim(line.substr(0, end));
+        line = (end == std::string_view::npos) ? std::string_view() : line.substr(end + 1);
+
+        return nullptr;
+    }
+
+    template <class T>
+    bool parse_number(std::string_view text, T& value) noexcept
+    {
+        // from_chars does not take a leading plus; it may only stand before the number itself, so "+-5" stays malformed.
+        if (text.size() > 1 && text.front() == '+' && ((text[1] >= '0' && text[1] <= '9') || text[1] == '.'))
+        {
+            text.remove_prefix(1);
+        }
+
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+
+        return not text.empty() && result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    // scores also have to be real numbers; from_chars takes "nan" and "inf" too.
+    bool parse_score(std::string_view text, double& value) noexcept
+    {
+        return parse_number(text, value) && std::isfinite(value);
+    }
+
+    bool same_name(std::string_view field, std::string_view name) noexcept
+    {
+        if (field.size() != name.size())
+        {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < name.size(); ++i)
+        {
+            char c = (field[i] >= 'A' && field[i] <= 'Z') ? static_cast<char>(field[i] - 'A' + 'a') : field[i];
+
+            if (c != name[i])
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // the header names the four columns, in any case; anything else on the first line is data.
+    bool is_header(const std::string_view (&fields)[4], std::size_t count) noexcept
+    {
+        return count == 4 && same_name(fields[0], "course_crn") && same_name(fields[1], "category")
+            && same_name(fields[2], "earned") && same_name(fields[3], "possible");
+    }
+}
+
+hyx::Csv_importer::Csv_importer(const std::vector<Course*>& courses, char delimiter, std::size_t chunk_size, std::size_t max_errors) :
+    courses_(),
+    delimiter_(delimiter),
+    chunk_size_(std::max<std::size_t>(chunk_size, 64)),
+    max_errors_(max_errors),
+    last_crn_(0),
+    last_course_(nullptr),
+    last_category_(),
+    last_id_(),
+    batch_course_(nullptr),
+    batch_()
+{
+    for (Course* course : courses)
+    {
+        this->courses_.emplace(course->get_crn(), course);
+    }
+
+    this->batch_.reserve(batch_size);
+}
+
+void hyx::Csv_importer::report(Import_summary& summary, std::size_t line, const char* reason)
+{
+    ++summary.malformed;
+
+    if (summary.errors.size() < this->max_errors_)
+    {
+        summary.errors.push_back({ line, reason });
+    }
+}
+
+void hyx::Csv_importer::skip(Import_summary& summary, std::size_t line, const char* reason)
+{
+    ++summary.skipped;
+
+    if (summary.errors.size() < this->max_errors_)
+    {
+        summary.errors.push_back({ line, reason });
+    }
+}
+
+void hyx::Csv_importer::import_line(std::string_view line, std::size_t number, Import_summary& summary)
+{
+    if (trim(line).empty())
+    {
+        return;
+    }
+
+    std::string_view fields[4];
+    std::string unescaped[4];
+    std::size_t count = 0;
+
+    while (count < 4 && not line.empty())
+    {
+        if (const char* reason = next_field(line, this->delimiter_, fields[count], unescaped[count]))
+        {
+            ++summary.rows;
+            this->report(summary, number, reason);
+
+            return;
+        }
+
+        ++count;
+    }
+
+    if (number == 1 && trim(line).empty() && is_header(fields, count))
+    {
+        return;
+    }
+
+    ++summary.rows;
+
+    long crn = 0;
+
+    if (not parse_number(fields[0], crn))
+    {
+        this->report(summary, number, "bad crn");
+
+        return;
+    }
+
+    if (count != 4 || not trim(line).empty())
+    {
+        this->report(summary, number, "expected 4 fields");
+
+        return;
+    }
+
+    double earned = 0.0;
+    double possible = 0.0;
+
+    if (not parse_score(fields[2], earned))
+    {
+        this->report(summary, number, "bad earned");
+
+        return;
+    }
+
+    if (not parse_score(fields[3], possible))
+    {
+        this->report(summary, number, "bad possible");
+
+        return;
+    }
+
+    if (this->last_course_ == nullptr || crn != this->last_crn_)
+    {
+        auto itr = this->courses_.find(crn);
+
+        if (itr == this->courses_.end())
+        {
+            this->report(summary, number, "unknown crn");
+
+            return;
+        }
+
+        this->last_crn_ = crn;
+        this->last_course_ = itr->second;
+        this->last_category_.clear();
+        this->last_id_ = Category_id();
+    }
+
+    // the course would refuse the grade; counted here rather than lost in the batch.
+    if (this->last_course_->is_withdrawn() || this->last_course_->is_replaced())
+    {
+        this->skip(summary, number, (this->last_course_->is_withdrawn()) ? "course withdrawn" : "course replaced");
+
+        return;
+    }
+
+    if (not this->last_id_ || fields[1] != this->last_category_)
+    {
+        this->last_category_.assign(fields[1]);
+        this->last_id_ = this->last_course_->get_category(this->last_category_);
+    }
+
+    if (not this->last_id_)
+    {
+        this->report(summary, number, "unknown category");
+
+        return;
+    }
+
+    if (this->batch_course_ != this->last_course_ || this->batch_.size() == batch_size)
+    {
+        this->flush(summary);
+        this->batch_course_ = this->last_course_;
+    }
+
+    this->batch_.push_back({ this->last_id_, earned, possible });
+}
+
+void hyx::Csv_importer::flush(Import_summary& summary)
+{
+    if (this->batch_course_ != nullptr && not this->batch_.empty())
+    {
+        summary.imported += this->batch_course_->add_grades(this->batch_);
+    }
+
+    this->batch_.clear();
+}
+
+hyx::Import_summary hyx::Csv_importer::import_fd(int fd)
+{
+    Import_summary summary{ 0, 0, 0, 0, {}, true };
+
+    std::vector<char> buffer(this->chunk_size_);
+    std::size_t filled = 0;
+    std::size_t number = 0;
+    bool skipping = false;
+    bool eof = false;
+
+    this->last_course_ = nullptr;
+    this->batch_course_ = nullptr;
+
+    while (not eof)
+    {
+        ssize_t got = ::read(fd, buffer.data() + filled, buffer.size() - filled);
+
+        if (got < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            summary.complete = false;
+            break;
+        }
+
+        eof = (got == 0);
+        filled += static_cast<std::size_t>(got);
+
+        std::size_t start = 0;
+
+        while (const char* newline = static_cast<const char*>(std::memchr(buffer.data() + start, '\n', filled - start)))
+        {
+            std::size_t end = static_cast<std::size_t>(newline - buffer.data());
+
+            ++number;
+
+            if (skipping)
+            {
+                skipping = false;
+            }
+            else
+            {
+                this->import_line(std::string_view(buffer.data() + start, end - start), number, summary);
+            }
+
+            start = end + 1;
+        }
+
+        if (eof)
+        {
+            if (start < filled && not skipping)
+            {
+                this->import_line(std::string_view(buffer.data() + start, filled - start), ++number, summary);
+            }
+
+            break;
+        }
+
+        std::memmove(buffer.data(), buffer.data() + start, filled - start);
+        filled -= start;
+
+        // a whole chunk without a newline: report the line once and drop it up to its end.
+        if (filled == buffer.size())
+        {
+            if (not skipping)
+            {
+                ++summary.rows;
+                this->report(summary, number + 1, "line too long");
+            }
+
+            skipping = true;
+            filled = 0;
+        }
+    }
+
+    this->flush(summary);
+
+    return summary;
+}
+
+hyx::Import_summary hyx::Csv_importer::import_file(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        return { 0, 0, 0, 0, {}, false };
+    }
+
+    Import_summary summary = this->import_fd(fd);
+
+    ::close(fd);
+
+    return summary;
+}
+
+hyx::Import_summary hyx::Csv_importer::import_text(std::string_view text)
+{
+    Import_summary summary{ 0, 0, 0, 0, {}, true };
+    std::size_t number = 0;
+
+    this->last_course_ = nullptr;
+    this->batch_course_ = nullptr;
+
+    while (not text.empty())
+    {
+        std::size_t end = text.find('\n');
+
+        this->import_line(text.substr(0, end), ++number, summary);
+        text = (end == std::string_view::npos) ? std::string_view() : text.substr(end + 1);
+    }
+
+    this->flush(summary);
+
+    return summary;
+}
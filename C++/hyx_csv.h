@@ -0,0 +1,93 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#ifndef HYX_CSV_H
+#define HYX_CSV_H
+
+#include <cstddef> // size_t
+#include <string> // string
+#include <string_view> // string_view
+#include <unordered_map> // unordered_map
+#include <vector> // vector
+
+#include "hyx_course.h"
+
+
+namespace hyx
+{
+    // a row that was skipped: line number (from 1) and why.
+    struct Import_error
+    {
+        std::size_t line;
+        const char* reason;
+    };
+
+    struct Import_summary
+    {
+        // data rows read, not counting blank lines or a header; a first line is only a header if it names the four columns.
+        std::size_t rows;
+
+        // grades the courses accepted.
+        std::size_t imported;
+
+        // rows that could not be read.
+        std::size_t malformed;
+
+        // well formed rows for a withdrawn or replaced course, which takes no grades.
+        std::size_t skipped;
+
+        // malformed and skipped rows alike; only the first max_errors of them are kept.
+        std::vector<Import_error> errors;
+
+        // false if reading stopped early on an I/O error.
+        bool complete;
+    };
+
+    // reads "course_crn, category, earned, possible" rows, with earned and possible finite numbers, and adds them to the matching courses in batches.
+    // a field may be double quoted, with "" for a quote inside it and nothing but spaces after it.
+    // input is read in fixed size chunks, so memory stays constant however big the file is; lines longer than a chunk are skipped.
+    class Csv_importer
+    {
+    private:
+
+        std::unordered_map<long, Course*> courses_;
+        char delimiter_;
+        std::size_t chunk_size_;
+        std::size_t max_errors_;
+
+        // the last course and category seen; exports list them in runs.
+        long last_crn_;
+        Course* last_course_;
+        std::string last_category_;
+        Category_id last_id_;
+
+        Course* batch_course_;
+        std::vector<Course::Grade_record> batch_;
+
+        void report(Import_summary& summary, std::size_t line, const char* reason);
+
+        void skip(Import_summary& summary, std::size_t line, const char* reason);
+
+        void import_line(std::string_view line, std::size_t number, Import_summary& summary);
+
+        void flush(Import_summary& summary);
+
+    public:
+
+        // courses are matched by CRN; if two share one, the first wins.
+        Csv_importer(const std::vector<Course*>& courses, char delimiter = ',', std::size_t chunk_size = 1 << 20, std::size_t max_errors = 1000);
+
+        Import_summary import_fd(int fd);
+
+        Import_summary import_file(const std::string& path);
+
+        Import_summary import_text(std::string_view text);
+
+    };
+
+} // hyx
+
+#endif // !HYX_CSV_H
@@ -0,0 +1,101 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#include "hyx_gradebook.h"
+
+#include <algorithm> //copy_n, max
+#include <numeric> //accumulate
+#include <utility> //move
+
+hyx::Gradebook::Gradebook() noexcept :
+    blocks_()
+{
+}
+
+hyx::Gradebook::Block& hyx::Gradebook::writable(std::uint32_t category, std::size_t capacity)
+{
+    Cow<Block>& block = this->blocks_[category];
+
+    if (block->capacity >= capacity)
+    {
+        return block.write();
+    }
+
+    // too small: a new block, so a shared one is copied once rather than copied and then grown; the other gradebooks keep the old one.
+    std::size_t size = block->size;
+    std::size_t new_capacity = std::max(capacity, block->capacity);
+    Block grown{ size, new_capacity, std::vector<double>(2 * new_capacity) };
+
+    std::copy_n(block->values.begin(), size, grown.values.begin());
+    std::copy_n(block->values.begin() + block->capacity, size, grown.values.begin() + new_capacity);
+
+    block = Cow<Block>(std::move(grown));
+
+    return block.write();
+}
+
+std::size_t hyx::Gradebook::categories() const noexcept
+{
+    return this->blocks_.size();
+}
+
+std::size_t hyx::Gradebook::size() const noexcept
+{
+    return std::accumulate(this->blocks_.begin(), this->blocks_.end(), std::size_t(0),
+        [](std::size_t sum, const Cow<Block>& block) { return sum + block->size; });
+}
+
+std::size_t hyx::Gradebook::size(std::uint32_t category) const noexcept
+{
+    return this->blocks_[category]->size;
+}
+
+std::size_t hyx::Gradebook::capacity(std::uint32_t category) const noexcept
+{
+    return this->blocks_[category]->capacity;
+}
+
+const double* hyx::Gradebook::earned(std::uint32_t category) const noexcept
+{
+    return this->blocks_[category]->values.data();
+}
+
+const double* hyx::Gradebook::possible(std::uint32_t category) const noexcept
+{
+    return this->blocks_[category]->values.data() + this->blocks_[category]->capacity;
+}
+
+bool hyx::Gradebook::is_shared(std::uint32_t category) const noexcept
+{
+    return this->blocks_[category].is_shared();
+}
+
+std::uint32_t hyx::Gradebook::add_category()
+{
+    this->blocks_.emplace_back(Block{ 0, 0, {} });
+
+    return static_cast<std::uint32_t>(this->blocks_.size() - 1);
+}
+
+void hyx::Gradebook::reserve(std::uint32_t category, std::size_t capacity)
+{
+    if (capacity > this->capacity(category))
+    {
+        this->writable(category, capacity);
+    }
+}
+
+void hyx::Gradebook::push_back(std::uint32_t category, double earn, double poss)
+{
+    std::size_t size = this->size(category);
+    std::size_t capacity = this->capacity(category);
+
+    Block& block = this->writable(category, (size == capacity) ? std::max<std::size_t>(4, capacity * 2) : capacity);
+
+    block.values[block.size] = earn;
+    block.values[block.capacity + block.size] = poss;
+    ++block.size;
+}
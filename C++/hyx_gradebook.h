@@ -0,0 +1,67 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#ifndef HYX_GRADEBOOK_H
+#define HYX_GRADEBOOK_H
+
+#include <cstddef> // size_t
+#include <cstdint> // uint32_t
+#include <vector> // vector
+
+#include "hyx_cow.h"
+
+
+namespace hyx
+{
+    // every score of a course, one block per category with its earned and possible points in two flat runs.
+    // copies share their blocks; a block is only copied when one of the gradebooks writes to that category.
+    class Gradebook
+    {
+    private:
+
+        // earned points in values[0, capacity), possible points in values[capacity, 2 * capacity)
+        struct Block
+        {
+            std::size_t size;
+            std::size_t capacity;
+            std::vector<double> values;
+        };
+
+        std::vector<Cow<Block>> blocks_;
+
+        // the block of category, owned by this gradebook alone and holding at least capacity scores.
+        Block& writable(std::uint32_t category, std::size_t capacity);
+
+    public:
+
+        Gradebook() noexcept;
+
+        [[nodiscard]] std::size_t categories() const noexcept;
+
+        [[nodiscard]] std::size_t size() const noexcept;
+
+        [[nodiscard]] std::size_t size(std::uint32_t category) const noexcept;
+
+        [[nodiscard]] std::size_t capacity(std::uint32_t category) const noexcept;
+
+        [[nodiscard]] const double* earned(std::uint32_t category) const noexcept;
+
+        [[nodiscard]] const double* possible(std::uint32_t category) const noexcept;
+
+        // true if a write to category would copy its scores first.
+        [[nodiscard]] bool is_shared(std::uint32_t category) const noexcept;
+
+        std::uint32_t add_category();
+
+        void reserve(std::uint32_t category, std::size_t capacity);
+
+        void push_back(std::uint32_t category, double earn, double poss);
+
+    };
+
+} // hyx
+
+#endif // !HYX_GRADEBOOK_H
@@ -0,0 +1,1552 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#include "hyx_json.h"
+
+#include <array> //array
+#include <charconv> //from_chars, to_chars
+#include <cmath> //abs, floor, isfinite
+#include <cstdint> //uint32_t
+
+namespace
+{
+    bool is_space(char c) noexcept
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    int hex_digit(char c) noexcept
+    {
+        if (c >= '0' && c <= '9')
+        {
+            return c - '0';
+        }
+
+        if (c >= 'a' && c <= 'f')
+        {
+            return c - 'a' + 10;
+        }
+
+        if (c >= 'A' && c <= 'F')
+        {
+            return c - 'A' + 10;
+        }
+
+        return -1;
+    }
+
+    void append_utf8(std::string& out, std::uint32_t code) noexcept
+    {
+        if (code < 0x80)
+        {
+            out.push_back(static_cast<char>(code));
+        }
+        else if (code < 0x800)
+        {
+            out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+        else if (code < 0x10000)
+        {
+            out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+        else
+        {
+            out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+    }
+
+    class Parser
+    {
+    private:
+
+        std::string_view text_;
+        std::size_t pos_;
+        hyx::json::Handler& handler_;
+        const char* reason_;
+
+        // unescaped strings land here; strings without escapes are handed out straight from the text.
+        std::string scratch_;
+
+        void skip_space() noexcept
+        {
+            while (this->pos_ < this->text_.size() && is_space(this->text_[this->pos_]))
+            {
+                ++this->pos_;
+            }
+        }
+
+        bool fail(const char* reason) noexcept
+        {
+            this->reason_ = reason;
+
+            return false;
+        }
+
+        bool read_hex4(std::uint32_t& code) noexcept
+        {
+            if (this->text_.size() - this->pos_ < 4)
+            {
+                return false;
+            }
+
+            code = 0;
+
+            for (int i = 0; i < 4; ++i)
+            {
+                int digit = hex_digit(this->text_[this->pos_++]);
+
+                if (digit < 0)
+                {
+                    return false;
+                }
+
+                code = code * 16 + static_cast<std::uint32_t>(digit);
+            }
+
+            return true;
+        }
+
+        // reads the string starting at the opening quote.
+        bool read_string(std::string_view& value)
+        {
+            std::size_t start = ++this->pos_;
+
+            while (this->pos_ < this->text_.size())
+            {
+                char c = this->text_[this->pos_];
+
+                if (c == '"')
+                {
+                    value = this->text_.substr(start, this->pos_ - start);
+                    ++this->pos_;
+
+                    return true;
+                }
+
+                if (c == '\\')
+                {
+                    break;
+                }
+
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    return this->fail("control character in string");
+                }
+
+                ++this->pos_;
+            }
+
+            this->scratch_.assign(this->text_.substr(start, this->pos_ - start));
+
+            while (this->pos_ < this->text_.size())
+            {
+                char c = this->text_[this->pos_++];
+
+                if (c == '"')
+                {
+                    value = this->scratch_;
+
+                    return true;
+                }
+
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    return this->fail("control character in string");
+                }
+
+                if (c != '\\')
+                {
+                    this->scratch_.push_back(c);
+                    continue;
+                }
+
+                if (this->pos_ == this->text_.size())
+                {
+                    break;
+                }
+
+                switch (this->text_[this->pos_++])
+                {
+                case '"': this->scratch_.push_back('"'); break;
+                case '\\': this->scratch_.push_back('\\'); break;
+                case '/': this->scratch_.push_back('/'); break;
+                case 'b': this->scratch_.push_back('\b'); break;
+                case 'f': this->scratch_.push_back('\f'); break;
+                case 'n': this->scratch_.push_back('\n'); break;
+                case 'r': this->scratch_.push_back('\r'); break;
+                case 't': this->scratch_.push_back('\t'); break;
+                case 'u':
+                {
+                    std::uint32_t code = 0;
+
+                    if (not this->read_hex4(code))
+                    {
+                        return this->fail("bad unicode escape");
+                    }
+
+                    // a low surrogate only ever follows a high one.
+                    if (code >= 0xDC00 && code <= 0xDFFF)
+                    {
+                        return this->fail("bad surrogate pair");
+                    }
+
+                    // a high surrogate must be followed by its low half.
+                    if (code >= 0xD800 && code <= 0xDBFF)
+                    {
+                        std::uint32_t low = 0;
+
+                        if (this->text_.substr(this->pos_, 2) != "\\u" || (this->pos_ += 2, not this->read_hex4(low)) || low < 0xDC00 || low > 0xDFFF)
+                        {
+                            return this->fail("bad surrogate pair");
+                        }
+
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+
+                    append_utf8(this->scratch_, code);
+                    break;
+                }
+                default:
+                    return this->fail("bad escape");
+                }
+            }
+
+            return this->fail("unterminated string");
+        }
+
+        bool accept(char c) noexcept
+        {
+            if (this->pos_ < this->text_.size() && this->text_[this->pos_] == c)
+            {
+                ++this->pos_;
+
+                return true;
+            }
+
+            return false;
+        }
+
+        std::size_t skip_digits() noexcept
+        {
+            std::size_t start = this->pos_;
+
+            while (this->pos_ < this->text_.size() && this->text_[this->pos_] >= '0' && this->text_[this->pos_] <= '9')
+            {
+                ++this->pos_;
+            }
+
+            return this->pos_ - start;
+        }
+
+        // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?, so "01", "1." and ".5" are all rejected.
+        bool read_number()
+        {
+            std::size_t start = this->pos_;
+            bool integral = true;
+
+            this->accept('-');
+
+            bool valid = (this->accept('0')) ? this->skip_digits() == 0 : this->skip_digits() != 0;
+
+            if (valid && this->accept('.'))
+            {
+                integral = false;
+                valid = this->skip_digits() != 0;
+            }
+
+            if (valid && (this->accept('e') || this->accept('E')))
+            {
+                integral = false;
+                valid = (this->accept('+') || this->accept('-'), this->skip_digits() != 0);
+            }
+
+            const char* first = this->text_.data() + start;
+            const char* last = this->text_.data() + this->pos_;
+
+            if (valid && integral)
+            {
+                long long value = 0;
+
+                // integers too large for a long long are read as doubles below.
+                if (std::from_chars(first, last, value).ec == std::errc())
+                {
+                    return this->handler_.integer(value) || this->fail("stopped by handler");
+                }
+            }
+
+            double value = 0.0;
+
+            if (not valid || std::from_chars(first, last, value).ec != std::errc())
+            {
+                this->pos_ = start;
+
+                return this->fail("bad number");
+            }
+
+            return this->handler_.number(value) || this->fail("stopped by handler");
+        }
+
+        bool read_literal(std::string_view literal)
+        {
+            if (this->text_.substr(this->pos_, literal.size()) != literal)
+            {
+                return this->fail("unexpected character");
+            }
+
+            this->pos_ += literal.size();
+
+            return true;
+        }
+
+    public:
+
+        Parser(std::string_view text, hyx::json::Handler& handler) :
+            text_(text),
+            pos_(0),
+            handler_(handler),
+            reason_(nullptr),
+            scratch_()
+        {
+        }
+
+        std::size_t offset() const noexcept
+        {
+            return this->pos_;
+        }
+
+        const char* reason() const noexcept
+        {
+            return this->reason_;
+        }
+
+        bool parse()
+        {
+            // '{' or '[' for every open container; the parse is a loop, so deep documents cannot overflow the call stack.
+            std::vector<char> open;
+            bool expect_key = false;
+
+            for (;;)
+            {
+                this->skip_space();
+
+                if (this->pos_ == this->text_.size())
+                {
+                    return this->fail("unexpected end of input");
+                }
+
+                if (expect_key)
+                {
+                    std::string_view name;
+
+                    if (this->text_[this->pos_] != '"')
+                    {
+                        return this->fail("expected a key");
+                    }
+
+                    if (not this->read_string(name))
+                    {
+                        return false;
+                    }
+
+                    if (not this->handler_.key(name))
+                    {
+                        return this->fail("stopped by handler");
+                    }
+
+                    this->skip_space();
+
+                    if (this->pos_ == this->text_.size() || this->text_[this->pos_] != ':')
+                    {
+                        return this->fail("expected ':'");
+                    }
+
+                    ++this->pos_;
+                    expect_key = false;
+                    continue;
+                }
+
+                char c = this->text_[this->pos_];
+                bool value_done = true;
+
+                if (c == '{' || c == '[')
+                {
+                    ++this->pos_;
+
+                    if (not ((c == '{') ? this->handler_.start_object() : this->handler_.start_array()))
+                    {
+                        return this->fail("stopped by handler");
+                    }
+
+                    this->skip_space();
+
+                    char close = (c == '{') ? '}' : ']';
+
+                    if (this->pos_ < this->text_.size() && this->text_[this->pos_] == close)
+                    {
+                        ++this->pos_;
+
+                        if (not ((c == '{') ? this->handler_.end_object() : this->handler_.end_array()))
+                        {
+                            return this->fail("stopped by handler");
+                        }
+                    }
+                    else
+                    {
+                        open.push_back(c);
+                        expect_key = (c == '{');
+                        value_done = false;
+                    }
+                }
+                else if (c == '"')
+                {
+                    std::string_view value;
+
+                    if (not this->read_string(value))
+                    {
+                        return false;
+                    }
+
+                    if (not this->handler_.string(value))
+                    {
+                        return this->fail("stopped by handler");
+                    }
+                }
+                else if (c == '-' || (c >= '0' && c <= '9'))
+                {
+                    if (not this->read_number())
+                    {
+                        return false;
+                    }
+                }
+                else if (c == 't' || c == 'f')
+                {
+                    if (not this->read_literal((c == 't') ? "true" : "false"))
+                    {
+                        return false;
+                    }
+
+                    if (not this->handler_.boolean(c == 't'))
+                    {
+                        return this->fail("stopped by handler");
+                    }
+                }
+                else if (c == 'n')
+                {
+                    if (not this->read_literal("null"))
+                    {
+                        return false;
+                    }
+
+                    if (not this->handler_.null())
+                    {
+                        return this->fail("stopped by handler");
+                    }
+                }
+                else
+                {
+                    return this->fail("unexpected character");
+                }
+
+                // after a value: a comma, the end of its container, or the end of the document.
+                while (value_done)
+                {
+                    this->skip_space();
+
+                    if (open.empty())
+                    {
+                        return this->pos_ == this->text_.size() || this->fail("trailing characters");
+                    }
+
+                    if (this->pos_ == this->text_.size())
+                    {
+                        return this->fail("unexpected end of input");
+                    }
+
+                    char next = this->text_[this->pos_];
+
+                    if (next == ',')
+                    {
+                        ++this->pos_;
+                        expect_key = (open.back() == '{');
+                        value_done = false;
+                    }
+                    else if (next == ((open.back() == '{') ? '}' : ']'))
+                    {
+                        ++this->pos_;
+
+                        if (not ((open.back() == '{') ? this->handler_.end_object() : this->handler_.end_array()))
+                        {
+                            return this->fail("stopped by handler");
+                        }
+
+                        open.pop_back();
+                    }
+                    else
+                    {
+                        return this->fail("expected ',' or a closing bracket");
+                    }
+                }
+            }
+        }
+    };
+
+    struct Category_draft
+    {
+        std::string name;
+        double weight;
+        int drops;
+        int replace_count;
+        std::string replace_with;
+        std::size_t first_score;
+        std::size_t score_count;
+    };
+
+    // everything a course object holds, collected until the object ends and the course can be built.
+    struct Course_draft
+    {
+        std::string name;
+        std::string institution;
+        std::string location;
+        std::string instructor;
+        std::string details;
+        std::string lab_location;
+        long crn;
+        int units;
+        bool has_crn;
+        bool has_lab;
+        std::string scale_name;
+        hyx::Grade_scale scale;
+        hyx::Grade_points points;
+        bool has_points;
+        std::string letter;
+        std::array<bool, 8> week_days;
+        std::array<bool, 8> lab_week_days;
+        std::array<int, 3> start_date;
+        std::array<int, 3> end_date;
+        std::array<int, 3> lab_start_date;
+        std::array<int, 3> lab_end_date;
+        std::array<int, 2> start_time;
+        std::array<int, 2> end_time;
+        std::array<int, 2> lab_start_time;
+        std::array<int, 2> lab_end_time;
+        double base_points;
+        double extra;
+        hyx::Course_status status;
+        std::vector<std::string> books;
+        std::vector<Category_draft> categories;
+
+        // earned, possible pairs of every category, in order.
+        std::vector<double> scores;
+
+        void reset()
+        {
+            this->name.clear();
+            this->institution.clear();
+            this->location.clear();
+            this->instructor.clear();
+            this->details.clear();
+            this->lab_location.clear();
+            this->crn = 0;
+            this->units = 0;
+            this->has_crn = false;
+            this->has_lab = false;
+            this->scale_name = "STD";
+            this->scale.clear();
+            this->points.clear();
+            this->has_points = false;
+            this->week_days = {};
+            this->lab_week_days = {};
+            this->start_date = { 0, 0, 0 };
+            this->end_date = { 0, 0, 0 };
+            this->lab_start_date = { 0, 0, 0 };
+            this->lab_end_date = { 0, 0, 0 };
+            this->start_time = { -1, -1 };
+            this->end_time = { -1, -1 };
+            this->lab_start_time = { -1, -1 };
+            this->lab_end_time = { -1, -1 };
+            this->base_points = 0.0;
+            this->extra = 0.0;
+            this->status = hyx::Course_status::active;
+            this->books.clear();
+            this->categories.clear();
+            this->scores.clear();
+        }
+    };
+
+    // builds courses from the events of one document.
+    class Course_handler
+        : public hyx::json::Handler
+    {
+    private:
+
+        enum class Frame
+        {
+            document,
+            courses,
+            course,
+            lab,
+            scale,
+            band,
+            points,
+            days,
+            ints,
+            books,
+            categories,
+            category,
+            replace,
+            scores,
+            score,
+            skip
+        };
+
+        struct Level
+        {
+            Frame frame;
+            std::size_t index;
+            bool* days;
+            int* ints;
+            std::size_t size;
+        };
+
+        std::vector<std::unique_ptr<hyx::Course>>& courses_;
+        std::vector<Level> levels_;
+        std::string key_;
+        Course_draft draft_;
+        const char* reason_;
+
+        bool fail(const char* reason) noexcept
+        {
+            this->reason_ = reason;
+
+            return false;
+        }
+
+        Level& top() noexcept
+        {
+            return this->levels_.back();
+        }
+
+        void push(Frame frame, bool* days = nullptr, int* ints = nullptr, std::size_t size = 0)
+        {
+            this->levels_.push_back({ frame, 0, days, ints, size });
+        }
+
+        // the array a date or time key of a course or lab object fills.
+        bool push_array_field(bool lab)
+        {
+            std::array<bool, 8>& days = (lab) ? this->draft_.lab_week_days : this->draft_.week_days;
+            std::array<int, 3>& start_date = (lab) ? this->draft_.lab_start_date : this->draft_.start_date;
+            std::array<int, 3>& end_date = (lab) ? this->draft_.lab_end_date : this->draft_.end_date;
+            std::array<int, 2>& start_time = (lab) ? this->draft_.lab_start_time : this->draft_.start_time;
+            std::array<int, 2>& end_time = (lab) ? this->draft_.lab_end_time : this->draft_.end_time;
+
+            if (this->key_ == "week_days")
+            {
+                this->push(Frame::days, days.data(), nullptr, days.size());
+            }
+            else if (this->key_ == "start_date")
+            {
+                this->push(Frame::ints, nullptr, start_date.data(), start_date.size());
+            }
+            else if (this->key_ == "end_date")
+            {
+                this->push(Frame::ints, nullptr, end_date.data(), end_date.size());
+            }
+            else if (this->key_ == "start_time")
+            {
+                this->push(Frame::ints, nullptr, start_time.data(), start_time.size());
+            }
+            else if (this->key_ == "end_time")
+            {
+                this->push(Frame::ints, nullptr, end_time.data(), end_time.size());
+            }
+            else
+            {
+                return false;
+            }
+
+            return true;
+        }
+
+        bool build()
+        {
+            Course_draft& draft = this->draft_;
+
+            if (not draft.has_crn)
+            {
+                return this->fail("course without a crn");
+            }
+
+            hyx::Shared_scale scale = hyx::scale::shared::STD();
+
+            if (draft.scale.size() > hyx::Compiled_scale::max_bands)
+            {
+                return this->fail("scale with too many bands");
+            }
+            else if (not draft.scale.empty())
+            {
+                scale = hyx::Shared_scale(draft.scale, (draft.has_points) ? draft.points : hyx::grade_points::STD);
+            }
+            else if (draft.scale_name == "STD")
+            {
+                scale = hyx::scale::shared::STD();
+            }
+            else if (draft.scale_name == "G11")
+            {
+                scale = hyx::scale::shared::G11();
+            }
+            else if (draft.scale_name == "U12")
+            {
+                scale = hyx::scale::shared::U12();
+            }
+            else if (draft.scale_name == "U11")
+            {
+                scale = hyx::scale::shared::U11();
+            }
+            else if (draft.scale_name == "PF")
+            {
+                scale = hyx::scale::shared::PF();
+            }
+            else
+            {
+                return this->fail("unknown scale");
+            }
+
+            std::unique_ptr<hyx::Course> course;
+
+            if (draft.has_lab)
+            {
+                course = std::make_unique<hyx::CourseWLAB>(draft.name, draft.crn, draft.units, scale, draft.institution, draft.location, draft.lab_location,
+                    draft.instructor, draft.details, draft.week_days, draft.lab_week_days, draft.start_date, draft.end_date, draft.lab_start_date, draft.lab_end_date,
+                    draft.start_time, draft.end_time, draft.lab_start_time, draft.lab_end_time);
+            }
+            else
+            {
+                course = std::make_unique<hyx::Course>(draft.name, draft.crn, draft.units, scale, draft.institution, draft.location,
+                    draft.instructor, draft.details, draft.week_days, draft.start_date, draft.end_date, draft.start_time, draft.end_time);
+            }
+
+            if (draft.base_points != 0.0)
+            {
+                course->set_point_based(draft.base_points);
+            }
+
+            std::vector<hyx::Course::Grade_record> grades;
+
+            grades.reserve(draft.scores.size() / 2);
+
+            for (const auto& category : draft.categories)
+            {
+                hyx::Category_id id = course->add_category(category.name, category.weight, category.drops, { category.replace_count, category.replace_with });
+
+                for (std::size_t i = 0; i < category.score_count; ++i)
+                {
+                    std::size_t at = 2 * (category.first_score + i);
+
+                    grades.push_back({ id, draft.scores[at], draft.scores[at + 1] });
+                }
+            }
+
+            course->add_grades(grades);
+
+            if (draft.extra != 0.0)
+            {
+                course->add_extra_to_total(draft.extra);
+            }
+
+            for (const auto& book : draft.books)
+            {
+                course->add_book(book);
+            }
+
+            switch (draft.status)
+            {
+            case hyx::Course_status::withdrawn: course->set_withdrawn(); break;
+            case hyx::Course_status::replaced: course->set_replaced(); break;
+            case hyx::Course_status::incomplete: course->set_incomplete(); break;
+            default: break;
+            }
+
+            this->courses_.push_back(std::move(course));
+
+            return true;
+        }
+
+        bool value_of_course(std::string_view text, double number, bool is_number)
+        {
+            const std::string& key = this->key_;
+
+            if (is_number)
+            {
+                if (key == "crn")
+                {
+                    // whole crns arrive through integer().
+                    return this->fail("crn must be an integer");
+                }
+                else if (key == "units")
+                {
+                    this->draft_.units = static_cast<int>(number);
+                }
+                else if (key == "point_based")
+                {
+                    this->draft_.base_points = number;
+                }
+                else if (key == "extra")
+                {
+                    this->draft_.extra = number;
+                }
+                else if (key == "name" || key == "institution" || key == "location" || key == "instructor" || key == "details" || key == "scale" || key == "status")
+                {
+                    return this->fail("expected a string");
+                }
+
+                return true;
+            }
+
+            if (key == "name")
+            {
+                this->draft_.name.assign(text);
+            }
+            else if (key == "institution")
+            {
+                this->draft_.institution.assign(text);
+            }
+            else if (key == "location")
+            {
+                this->draft_.location.assign(text);
+            }
+            else if (key == "instructor")
+            {
+                this->draft_.instructor.assign(text);
+            }
+            else if (key == "details")
+            {
+                this->draft_.details.assign(text);
+            }
+            else if (key == "scale")
+            {
+                this->draft_.scale_name.assign(text);
+            }
+            else if (key == "status")
+            {
+                if (text == "active")
+                {
+                    this->draft_.status = hyx::Course_status::active;
+                }
+                else if (text == "withdrawn")
+                {
+                    this->draft_.status = hyx::Course_status::withdrawn;
+                }
+                else if (text == "replaced")
+                {
+                    this->draft_.status = hyx::Course_status::replaced;
+                }
+                else if (text == "incomplete")
+                {
+                    this->draft_.status = hyx::Course_status::incomplete;
+                }
+                else
+                {
+                    return this->fail("unknown status");
+                }
+            }
+            else if (key == "crn" || key == "units" || key == "point_based" || key == "extra")
+            {
+                return this->fail("expected a number");
+            }
+
+            return true;
+        }
+
+        // a string (is_number false) or number in the current container.
+        bool value(std::string_view text, double number, bool is_number)
+        {
+            if (this->levels_.empty())
+            {
+                return this->fail("expected an object or array");
+            }
+
+            Level& level = this->top();
+
+            switch (level.frame)
+            {
+            case Frame::skip:
+            case Frame::document:
+                return true;
+            case Frame::course:
+                return this->value_of_course(text, number, is_number);
+            case Frame::lab:
+                if (this->key_ == "location")
+                {
+                    if (is_number)
+                    {
+                        return this->fail("expected a string");
+                    }
+
+                    this->draft_.lab_location.assign(text);
+                }
+
+                return true;
+            case Frame::band:
+                if (not is_number || level.index >= 2)
+                {
+                    return this->fail("a band is [low, high]");
+                }
+
+                {
+                    auto& band = this->draft_.scale[this->draft_.letter];
+
+                    ((level.index++ == 0) ? band.first : band.second) = static_cast<int>(number);
+                }
+
+                return true;
+            case Frame::points:
+                if (not is_number)
+                {
+                    return this->fail("expected a number");
+                }
+
+                this->draft_.points[this->key_] = number;
+                this->draft_.has_points = true;
+
+                return true;
+            case Frame::ints:
+                if (not is_number || level.index >= level.size)
+                {
+                    return this->fail("too many values in a date or time");
+                }
+
+                level.ints[level.index++] = static_cast<int>(number);
+
+                return true;
+            case Frame::books:
+                if (is_number)
+                {
+                    return this->fail("expected a string");
+                }
+
+                this->draft_.books.emplace_back(text);
+
+                return true;
+            case Frame::category:
+            {
+                Category_draft& category = this->draft_.categories.back();
+
+                if (this->key_ == "name")
+                {
+                    category.name.assign(text);
+                }
+                else if (this->key_ == "weight")
+                {
+                    category.weight = number;
+                }
+                else if (this->key_ == "drops")
+                {
+                    category.drops = static_cast<int>(number);
+                }
+                else
+                {
+                    return true;
+                }
+
+                return (is_number == (this->key_ != "name")) || this->fail("wrong type in a category");
+            }
+            case Frame::replace:
+            {
+                Category_draft& category = this->draft_.categories.back();
+
+                if (this->key_ == "count" && is_number)
+                {
+                    category.replace_count = static_cast<int>(number);
+                }
+                else if (this->key_ == "with" && not is_number)
+                {
+                    category.replace_with.assign(text);
+                }
+                else if (this->key_ == "count" || this->key_ == "with")
+                {
+                    return this->fail("wrong type in a replace rule");
+                }
+
+                return true;
+            }
+            case Frame::score:
+                if (not is_number || level.index >= 2)
+                {
+                    return this->fail("a score is [earned, possible]");
+                }
+
+                this->draft_.scores.push_back(number);
+                ++level.index;
+
+                return true;
+            default:
+                return this->fail("unexpected value");
+            }
+        }
+
+    public:
+
+        explicit Course_handler(std::vector<std::unique_ptr<hyx::Course>>& courses) :
+            courses_(courses),
+            levels_(),
+            key_(),
+            draft_(),
+            reason_(nullptr)
+        {
+        }
+
+        const char* reason() const noexcept
+        {
+            return this->reason_;
+        }
+
+        bool null() override
+        {
+            return true;
+        }
+
+        bool boolean(bool value) override
+        {
+            if (not this->levels_.empty() && this->top().frame == Frame::days)
+            {
+                Level& level = this->top();
+
+                if (level.index >= level.size)
+                {
+                    return this->fail("week_days holds 8 values");
+                }
+
+                level.days[level.index++] = value;
+            }
+
+            return true;
+        }
+
+        bool number(double value) override
+        {
+            return this->value(std::string_view(), value, true);
+        }
+
+        // a crn is kept as the integer it was written as, so it does not pass through a double.
+        bool integer(long long value) override
+        {
+            if (not this->levels_.empty() && this->top().frame == Frame::course && this->key_ == "crn")
+            {
+                this->draft_.crn = static_cast<long>(value);
+                this->draft_.has_crn = true;
+
+                return true;
+            }
+
+            return this->number(static_cast<double>(value));
+        }
+
+        bool string(std::string_view value) override
+        {
+            return this->value(value, 0.0, false);
+        }
+
+        bool key(std::string_view name) override
+        {
+            this->key_.assign(name);
+
+            return true;
+        }
+
+        bool start_object() override
+        {
+            if (this->levels_.empty())
+            {
+                this->push(Frame::document);
+
+                return true;
+            }
+
+            switch (this->top().frame)
+            {
+            case Frame::document:
+            case Frame::skip:
+            case Frame::days:
+            case Frame::ints:
+            case Frame::books:
+            case Frame::band:
+            case Frame::points:
+            case Frame::scores:
+            case Frame::score:
+                this->push(Frame::skip);
+                break;
+            case Frame::courses:
+                this->draft_.reset();
+                this->push(Frame::course);
+                break;
+            case Frame::course:
+                if (this->key_ == "scale")
+                {
+                    this->push(Frame::scale);
+                }
+                else if (this->key_ == "points")
+                {
+                    this->push(Frame::points);
+                }
+                else if (this->key_ == "lab")
+                {
+                    this->draft_.has_lab = true;
+                    this->push(Frame::lab);
+                }
+                else
+                {
+                    this->push(Frame::skip);
+                }
+                break;
+            case Frame::categories:
+                this->draft_.categories.push_back({ "", 0.0, 0, 0, "", this->draft_.scores.size() / 2, 0 });
+                this->push(Frame::category);
+                break;
+            case Frame::category:
+                this->push((this->key_ == "replace") ? Frame::replace : Frame::skip);
+                break;
+            default:
+                this->push(Frame::skip);
+                break;
+            }
+
+            return true;
+        }
+
+        bool end_object() override
+        {
+            Frame frame = this->top().frame;
+
+            this->levels_.pop_back();
+
+            return (frame == Frame::course) ? this->build() : true;
+        }
+
+        bool start_array() override
+        {
+            if (this->levels_.empty())
+            {
+                this->push(Frame::courses);
+
+                return true;
+            }
+
+            switch (this->top().frame)
+            {
+            case Frame::document:
+                this->push((this->key_ == "courses") ? Frame::courses : Frame::skip);
+                break;
+            case Frame::course:
+                if (this->key_ == "books")
+                {
+                    this->push(Frame::books);
+                }
+                else if (this->key_ == "categories")
+                {
+                    this->push(Frame::categories);
+                }
+                else if (not this->push_array_field(false))
+                {
+                    this->push(Frame::skip);
+                }
+                break;
+            case Frame::lab:
+                if (not this->push_array_field(true))
+                {
+                    this->push(Frame::skip);
+                }
+                break;
+            case Frame::scale:
+                this->draft_.letter = this->key_;
+                this->draft_.scale[this->draft_.letter] = { 0, 0 };
+                this->push(Frame::band);
+                break;
+            case Frame::category:
+                this->push((this->key_ == "scores") ? Frame::scores : Frame::skip);
+                break;
+            case Frame::scores:
+                this->push(Frame::score);
+                break;
+            default:
+                this->push(Frame::skip);
+                break;
+            }
+
+            return true;
+        }
+
+        bool end_array() override
+        {
+            Level level = this->top();
+
+            this->levels_.pop_back();
+
+            if (level.frame == Frame::score)
+            {
+                if (level.index != 2)
+                {
+                    return this->fail("a score is [earned, possible]");
+                }
+
+                ++this->draft_.categories.back().score_count;
+            }
+
+            return true;
+        }
+    };
+
+    const char* scale_name(const hyx::Shared_scale& scale)
+    {
+        if (scale == hyx::scale::shared::STD())
+        {
+            return "STD";
+        }
+
+        if (scale == hyx::scale::shared::G11())
+        {
+            return "G11";
+        }
+
+        if (scale == hyx::scale::shared::U12())
+        {
+            return "U12";
+        }
+
+        if (scale == hyx::scale::shared::U11())
+        {
+            return "U11";
+        }
+
+        if (scale == hyx::scale::shared::PF())
+        {
+            return "PF";
+        }
+
+        return nullptr;
+    }
+
+    template <std::size_t N>
+    void append_ints(std::string& out, const std::array<int, N>& values)
+    {
+        out.push_back('[');
+
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            if (i != 0)
+            {
+                out.push_back(',');
+            }
+
+            hyx::json::append_number(out, values[i]);
+        }
+
+        out.push_back(']');
+    }
+
+    void append_days(std::string& out, const std::array<bool, 8>& days)
+    {
+        out.push_back('[');
+
+        for (std::size_t i = 0; i < days.size(); ++i)
+        {
+            out.append((i != 0) ? "," : "").append((days[i]) ? "true" : "false");
+        }
+
+        out.push_back(']');
+    }
+
+    // dates that are not real days are written as [0,0,0] and missing times as [-1,-1], the values a reader assumes.
+    void append_schedule(std::string& out, const hyx::Schedule& schedule)
+    {
+        out.append("\"week_days\":");
+        append_days(out, hyx::schedule::unpack_week_days(schedule.week_days));
+        out.append(",\"start_date\":");
+        append_ints(out, hyx::schedule::civil_from_days(schedule.start_day));
+        out.append(",\"end_date\":");
+        append_ints(out, hyx::schedule::civil_from_days(schedule.end_day));
+        out.append(",\"start_time\":");
+        append_ints(out, hyx::schedule::unpack_time(schedule.start_minute));
+        out.append(",\"end_time\":");
+        append_ints(out, hyx::schedule::unpack_time(schedule.end_minute));
+    }
+}
+
+bool hyx::json::parse(std::string_view text, Handler& handler, Error* error)
+{
+    Parser parser(text, handler);
+
+    bool good = parser.parse();
+
+    if (not good && error != nullptr)
+    {
+        *error = { parser.offset(), parser.reason() };
+    }
+
+    return good;
+}
+
+void hyx::json::append_string(std::string& out, std::string_view value)
+{
+    static constexpr char hex[] = "0123456789abcdef";
+
+    out.push_back('"');
+
+    for (char c : value)
+    {
+        switch (c)
+        {
+        case '"': out.append("\\\""); break;
+        case '\\': out.append("\\\\"); break;
+        case '\n': out.append("\\n"); break;
+        case '\r': out.append("\\r"); break;
+        case '\t': out.append("\\t"); break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                out.append("\\u00");
+                out.push_back(hex[(c >> 4) & 0xF]);
+                out.push_back(hex[c & 0xF]);
+            }
+            else
+            {
+                out.push_back(c);
+            }
+        }
+    }
+
+    out.push_back('"');
+}
+
+bool hyx::json::append_number(std::string& out, double value)
+{
+    char buff[32];
+
+    // JSON has no NaN or infinity; to_chars would write "nan" and "inf".
+    if (not std::isfinite(value))
+    {
+        out.append("null");
+
+        return false;
+    }
+
+    // the shortest form of 100000 is "1e+05"; whole numbers read better as integers.
+    if (value == std::floor(value) && std::abs(value) < 9007199254740992.0)
+    {
+        append_integer(out, static_cast<long long>(value));
+
+        return true;
+    }
+
+    out.append(buff, std::to_chars(buff, buff + sizeof(buff), value).ptr);
+
+    return true;
+}
+
+void hyx::json::append_integer(std::string& out, long long value)
+{
+    char buff[24];
+
+    out.append(buff, std::to_chars(buff, buff + sizeof(buff), value).ptr);
+}
+
+bool hyx::Course_json::write_course(std::string& out, const Course& course)
+{
+    bool finite = true;
+
+    out.append("{\"name\":");
+    json::append_string(out, course.info_->name);
+    out.append(",\"crn\":");
+    json::append_integer(out, course.crn_);
+    out.append(",\"units\":");
+    finite &= json::append_number(out, course.units_);
+    out.append(",\"scale\":");
+
+    if (const char* name = scale_name(course.scale_))
+    {
+        json::append_string(out, name);
+    }
+    else
+    {
+        const Compiled_scale& scale = *course.scale_;
+
+        out.push_back('{');
+
+        for (std::size_t i = 0; i < scale.size(); ++i)
+        {
+            const Compiled_scale::Band& band = scale.get_band(static_cast<std::uint8_t>(i));
+
+            out.append((i != 0) ? "," : "");
+            json::append_string(out, scale.get_letter(static_cast<std::uint8_t>(i)));
+            out.append(":[");
+            finite &= json::append_number(out, band.low);
+            out.push_back(',');
+            finite &= json::append_number(out, band.high);
+            out.push_back(']');
+        }
+
+        out.append("},\"points\":{");
+
+        bool first = true;
+
+        for (std::size_t i = 0; i < scale.size(); ++i)
+        {
+            double points = scale.get_points(static_cast<std::uint8_t>(i));
+
+            if (points >= 0)
+            {
+                out.append((first) ? "" : ",");
+                json::append_string(out, scale.get_letter(static_cast<std::uint8_t>(i)));
+                out.push_back(':');
+                finite &= json::append_number(out, points);
+                first = false;
+            }
+        }
+
+        out.push_back('}');
+    }
+
+    out.append(",\"institution\":");
+    json::append_string(out, course.info_->institution);
+    out.append(",\"location\":");
+    json::append_string(out, course.info_->location);
+    out.append(",\"instructor\":");
+    json::append_string(out, course.info_->instructor);
+    out.append(",\"details\":");
+    json::append_string(out, course.info_->details);
+    out.push_back(',');
+    append_schedule(out, course.schedule_);
+
+    if (course.base_points_ != 0.0)
+    {
+        out.append(",\"point_based\":");
+        finite &= json::append_number(out, course.base_points_);
+    }
+
+    if (course.extra_ != 0.0)
+    {
+        out.append(",\"extra\":");
+        finite &= json::append_number(out, course.extra_);
+    }
+
+    static constexpr const char* statuses[] = { "active", "withdrawn", "replaced", "incomplete" };
+
+    out.append(",\"status\":");
+    json::append_string(out, statuses[static_cast<std::size_t>(course.status_)]);
+    out.append(",\"books\":[");
+
+    for (std::size_t i = 0; i < course.info_->books.size(); ++i)
+    {
+        out.append((i != 0) ? "," : "");
+        json::append_string(out, course.info_->books[i]);
+    }
+
+    out.append("],\"categories\":[");
+
+    for (std::uint32_t id = 0; id < course.points_.size(); ++id)
+    {
+        const Course::Category& category = *course.points_[id];
+        const double* earned = course.scores_.earned(id);
+        const double* possible = course.scores_.possible(id);
+
+        out.append((id != 0) ? ",{\"name\":" : "{\"name\":");
+        json::append_string(out, category.name);
+        out.append(",\"weight\":");
+        finite &= json::append_number(out, category.weight);
+        out.append(",\"drops\":");
+        finite &= json::append_number(out, category.drops);
+
+        if (category.replace.first != 0 || not category.replace.second.empty())
+        {
+            out.append(",\"replace\":{\"count\":");
+            finite &= json::append_number(out, category.replace.first);
+            out.append(",\"with\":");
+            json::append_string(out, category.replace.second);
+            out.push_back('}');
+        }
+
+        out.append(",\"scores\":[");
+
+        for (std::size_t i = 0; i < course.scores_.size(id); ++i)
+        {
+            out.append((i != 0) ? ",[" : "[");
+            finite &= json::append_number(out, earned[i]);
+            out.push_back(',');
+            finite &= json::append_number(out, possible[i]);
+            out.push_back(']');
+        }
+
+        out.append("]}");
+    }
+
+    out.push_back(']');
+
+    if (const CourseWLAB* lab = dynamic_cast<const CourseWLAB*>(&course))
+    {
+        out.append(",\"lab\":{\"location\":");
+        json::append_string(out, *lab->lab_location_);
+        out.push_back(',');
+        append_schedule(out, lab->lab_schedule_);
+        out.push_back('}');
+    }
+
+    out.push_back('}');
+
+    return finite;
+}
+
+bool hyx::Course_json::write(std::string& out, const std::vector<const Course*>& courses)
+{
+    std::size_t start = out.size();
+
+    out.append("{\"courses\":[");
+
+    for (std::size_t i = 0; i < courses.size(); ++i)
+    {
+        out.append((i != 0) ? ",\n" : "\n");
+
+        if (not write_course(out, *courses[i]))
+        {
+            out.resize(start);
+
+            return false;
+        }
+    }
+
+    out.append("\n]}\n");
+
+    return true;
+}
+
+bool hyx::Course_json::read(std::string_view text, std::vector<std::unique_ptr<Course>>& courses, json::Error* error)
+{
+    std::vector<std::unique_ptr<Course>> loaded;
+    Course_handler handler(loaded);
+    json::Error parse_error{ 0, nullptr };
+
+    if (not json::parse(text, handler, &parse_error))
+    {
+        if (error != nullptr)
+        {
+            *error = { parse_error.offset, (handler.reason() != nullptr) ? handler.reason() : parse_error.reason };
+        }
+
+        return false;
+    }
+
+    for (auto& course : loaded)
+    {
+        courses.push_back(std::move(course));
+    }
+
+    return true;
+}
@@ -0,0 +1,102 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#ifndef HYX_JSON_H
+#define HYX_JSON_H
+
+#include <cstddef> // size_t
+#include <memory> // unique_ptr
+#include <string> // string
+#include <string_view> // string_view
+#include <vector> // vector
+
+#include "hyx_course.h"
+
+
+// a SAX style JSON parser: values are handed to a Handler as they are read and no tree is ever built.
+namespace hyx::json
+{
+    // strings and keys are only valid for the length of the call.
+    class Handler
+    {
+    public:
+
+        virtual ~Handler() = default;
+
+        // returning false from any event stops the parse.
+        virtual bool null() = 0;
+
+        virtual bool boolean(bool value) = 0;
+
+        virtual bool number(double value) = 0;
+
+        // numbers written without a fraction or exponent that fit in a long long; handed on to number() unless overridden.
+        virtual bool integer(long long value)
+        {
+            return this->number(static_cast<double>(value));
+        }
+
+        virtual bool string(std::string_view value) = 0;
+
+        virtual bool key(std::string_view name) = 0;
+
+        virtual bool start_object() = 0;
+
+        virtual bool end_object() = 0;
+
+        virtual bool start_array() = 0;
+
+        virtual bool end_array() = 0;
+
+    };
+
+    // byte offset into the text and why parsing stopped.
+    struct Error
+    {
+        std::size_t offset;
+        const char* reason;
+    };
+
+    // false on a syntax error or when the handler stops; error, if given, says where.
+    bool parse(std::string_view text, Handler& handler, Error* error = nullptr);
+
+    // appends value as a quoted, escaped JSON string.
+    void append_string(std::string& out, std::string_view value);
+
+    // appends the shortest text that reads back as the same double; whole numbers are written as integers.
+    // JSON cannot hold NaN or infinity, so those append null and return false.
+    bool append_number(std::string& out, double value);
+
+    // appends every digit of value, however large.
+    void append_integer(std::string& out, long long value);
+
+} // hyx::json
+
+namespace hyx
+{
+    // course definitions, categories, scales and scores as JSON:
+    // {"courses": [{"name": ..., "crn": ..., "scale": "U12" or {"A": [93, 100], ...}, "categories": [{"name": ..., "scores": [[9, 10], ...]}], ...}]}
+    class Course_json
+    {
+    private:
+
+        // false if a number in the course is NaN or infinite.
+        static bool write_course(std::string& out, const Course& course);
+
+    public:
+
+        // appends every course as one document; false, with nothing appended, if a score, weight or other number is NaN or infinite.
+        static bool write(std::string& out, const std::vector<const Course*>& courses);
+
+        // appends every course in text to courses, as a CourseWLAB when it has a "lab" object.
+        // nothing is appended if the document is malformed; error, if given, says where.
+        static bool read(std::string_view text, std::vector<std::unique_ptr<Course>>& courses, json::Error* error = nullptr);
+
+    };
+
+} // hyx
+
+#endif // !HYX_JSON_H
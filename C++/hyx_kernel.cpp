@@ -0,0 +1,179 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#include "hyx_kernel.h"
+
+#if !defined(HYX_NO_SIMD) && (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && defined(__SSE2__)
+#define HYX_KERNEL_X86 1
+#include <immintrin.h> //_mm_*, _mm256_*
+#endif
+
+namespace
+{
+    void divide_scalar(const double* earned, const double* possible, double* out, std::size_t count) noexcept
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            out[i] = earned[i] / possible[i];
+        }
+    }
+
+    // sum plus the terms from first on, added one at a time in index order; the vector kernels finish their tails with it.
+    double add_ratios(double sum, const double* weight, const double* earned, const double* possible, std::size_t first, std::size_t count) noexcept
+    {
+        for (std::size_t i = first; i < count; ++i)
+        {
+            sum += weight[i] * (earned[i] / possible[i]);
+        }
+
+        return sum;
+    }
+
+    double weighted_ratio_sum_scalar(const double* weight, const double* earned, const double* possible, std::size_t count) noexcept
+    {
+        return add_ratios(0.0, weight, earned, possible, 0, count);
+    }
+
+#ifdef HYX_KERNEL_X86
+    void divide_sse2(const double* earned, const double* possible, double* out, std::size_t count) noexcept
+    {
+        std::size_t i = 0;
+
+        for (; i + 2 <= count; i += 2)
+        {
+            _mm_storeu_pd(out + i, _mm_div_pd(_mm_loadu_pd(earned + i), _mm_loadu_pd(possible + i)));
+        }
+
+        divide_scalar(earned + i, possible + i, out + i, count - i);
+    }
+
+    // the terms are worked out two at a time but added one at a time, in index order.
+    double weighted_ratio_sum_sse2(const double* weight, const double* earned, const double* possible, std::size_t count) noexcept
+    {
+        double sum = 0.0;
+        std::size_t i = 0;
+
+        for (; i + 2 <= count; i += 2)
+        {
+            __m128d terms = _mm_mul_pd(_mm_loadu_pd(weight + i), _mm_div_pd(_mm_loadu_pd(earned + i), _mm_loadu_pd(possible + i)));
+
+            sum += _mm_cvtsd_f64(terms);
+            sum += _mm_cvtsd_f64(_mm_unpackhi_pd(terms, terms));
+        }
+
+        return add_ratios(sum, weight, earned, possible, i, count);
+    }
+
+    __attribute__((target("avx2"))) void divide_avx2(const double* earned, const double* possible, double* out, std::size_t count) noexcept
+    {
+        std::size_t i = 0;
+
+        for (; i + 4 <= count; i += 4)
+        {
+            _mm256_storeu_pd(out + i, _mm256_div_pd(_mm256_loadu_pd(earned + i), _mm256_loadu_pd(possible + i)));
+        }
+
+        divide_sse2(earned + i, possible + i, out + i, count - i);
+    }
+
+    __attribute__((target("avx2"))) double weighted_ratio_sum_avx2(const double* weight, const double* earned, const double* possible, std::size_t count) noexcept
+    {
+        double sum = 0.0;
+        double terms[4];
+        std::size_t i = 0;
+
+        for (; i + 4 <= count; i += 4)
+        {
+            _mm256_storeu_pd(terms, _mm256_mul_pd(_mm256_loadu_pd(weight + i), _mm256_div_pd(_mm256_loadu_pd(earned + i), _mm256_loadu_pd(possible + i))));
+
+            sum += terms[0];
+            sum += terms[1];
+            sum += terms[2];
+            sum += terms[3];
+        }
+
+        return add_ratios(sum, weight, earned, possible, i, count);
+    }
+#endif
+
+    constexpr hyx::kernel::Table scalar_table{ divide_scalar, weighted_ratio_sum_scalar, "scalar" };
+
+#ifdef HYX_KERNEL_X86
+    constexpr hyx::kernel::Table sse2_table{ divide_sse2, weighted_ratio_sum_sse2, "sse2" };
+    constexpr hyx::kernel::Table avx2_table{ divide_avx2, weighted_ratio_sum_avx2, "avx2" };
+
+    bool has_avx2() noexcept
+    {
+        __builtin_cpu_init();
+
+        return __builtin_cpu_supports("avx2");
+    }
+#endif
+
+    const hyx::kernel::Table& kernels() noexcept
+    {
+        static const hyx::kernel::Table& selected = []() -> const hyx::kernel::Table& {
+#ifdef HYX_KERNEL_X86
+            return (has_avx2()) ? avx2_table : sse2_table;
+#else
+            return scalar_table;
+#endif
+        }();
+
+        return selected;
+    }
+}
+
+void hyx::kernel::divide(const double* earned, const double* possible, double* out, std::size_t count) noexcept
+{
+    kernels().divide(earned, possible, out, count);
+}
+
+std::pair<double, double> hyx::kernel::sum_pair(const double* earned, const double* possible, std::size_t count) noexcept
+{
+    double sum_earned = 0.0;
+    double sum_possible = 0.0;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        sum_earned += earned[i];
+        sum_possible += possible[i];
+    }
+
+    return { sum_earned, sum_possible };
+}
+
+double hyx::kernel::weighted_ratio_sum(const double* weight, const double* earned, const double* possible, std::size_t count) noexcept
+{
+    return kernels().weighted_ratio_sum(weight, earned, possible, count);
+}
+
+const char* hyx::kernel::instruction_set() noexcept
+{
+    return kernels().name;
+}
+
+const hyx::kernel::Table* hyx::kernel::table(std::string_view instruction_set) noexcept
+{
+    if (instruction_set == scalar_table.name)
+    {
+        return &scalar_table;
+    }
+
+#ifdef HYX_KERNEL_X86
+    if (instruction_set == sse2_table.name)
+    {
+        return &sse2_table;
+    }
+
+    if (instruction_set == avx2_table.name && has_avx2())
+    {
+        return &avx2_table;
+    }
+#endif
+
+    return nullptr;
+}
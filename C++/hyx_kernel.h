@@ -0,0 +1,43 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#ifndef HYX_KERNEL_H
+#define HYX_KERNEL_H
+
+#include <cstddef> // size_t
+#include <string_view> // string_view
+#include <utility> // pair
+
+
+// the kernels pick AVX2, SSE2 or plain loops once at run time; define HYX_NO_SIMD to always use the plain loops.
+namespace hyx::kernel
+{
+    // out[i] = earned[i] / possible[i]
+    void divide(const double* earned, const double* possible, double* out, std::size_t count) noexcept;
+
+    // (sum of earned, sum of possible), added in index order; always a plain loop, since any other order changes the bits of the total.
+    [[nodiscard]] std::pair<double, double> sum_pair(const double* earned, const double* possible, std::size_t count) noexcept;
+
+    // sum of weight[i] * earned[i] / possible[i]; the terms may be worked out together but are added in index order.
+    [[nodiscard]] double weighted_ratio_sum(const double* weight, const double* earned, const double* possible, std::size_t count) noexcept;
+
+    // "avx2", "sse2" or "scalar"
+    [[nodiscard]] const char* instruction_set() noexcept;
+
+    // the kernels of one instruction set, so they can be checked against each other.
+    struct Table
+    {
+        void (*divide)(const double*, const double*, double*, std::size_t) noexcept;
+        double (*weighted_ratio_sum)(const double*, const double*, const double*, std::size_t) noexcept;
+        const char* name;
+    };
+
+    // "avx2", "sse2" or "scalar"; null if this build or machine cannot run it.
+    [[nodiscard]] const Table* table(std::string_view instruction_set) noexcept;
+
+} // hyx::kernel
+
+#endif // !HYX_KERNEL_H
@@ -0,0 +1,134 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#include "hyx_parallel.h"
+
+#include <algorithm> //min, max
+#include <mutex> //mutex, lock_guard
+#include <thread> //thread, hardware_concurrency
+#include <vector> //vector
+
+namespace
+{
+    // the items a thread has left to do.
+    struct Share
+    {
+        std::mutex lock;
+        std::size_t first = 0;
+        std::size_t last = 0;
+    };
+
+    bool take(Share& share, std::size_t grain, std::size_t& first, std::size_t& last)
+    {
+        std::lock_guard<std::mutex> guard(share.lock);
+
+        if (share.first == share.last)
+        {
+            return false;
+        }
+
+        first = share.first;
+        last = std::min(share.last, share.first + grain);
+        share.first = last;
+
+        return true;
+    }
+
+    bool steal(Share& victim, Share& thief)
+    {
+        std::size_t first;
+        std::size_t last;
+
+        {
+            std::lock_guard<std::mutex> guard(victim.lock);
+
+            if (victim.first == victim.last)
+            {
+                return false;
+            }
+
+            last = victim.last;
+            first = victim.last - (victim.last - victim.first + 1) / 2;
+            victim.last = first;
+        }
+
+        std::lock_guard<std::mutex> guard(thief.lock);
+
+        thief.first = first;
+        thief.last = last;
+
+        return true;
+    }
+}
+
+unsigned int hyx::default_threads() noexcept
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void hyx::parallel_for(std::size_t count, unsigned int threads, const std::function<void(std::size_t, std::size_t)>& body, std::size_t grain)
+{
+    grain = std::max<std::size_t>(grain, 1);
+    threads = (threads == 0) ? default_threads() : threads;
+    threads = static_cast<unsigned int>(std::min<std::size_t>(threads, (count + grain - 1) / grain));
+
+    if (threads <= 1)
+    {
+        for (std::size_t first = 0; first < count; first += grain)
+        {
+            body(first, std::min(count, first + grain));
+        }
+
+        return;
+    }
+
+    std::vector<Share> shares(threads);
+
+    for (unsigned int i = 0; i < threads; ++i)
+    {
+        shares[i].first = count * i / threads;
+        shares[i].last = count * (i + 1) / threads;
+    }
+
+    auto steal_any = [&](unsigned int self) {
+        for (unsigned int i = 1; i < threads; ++i)
+        {
+            if (steal(shares[(self + i) % threads], shares[self]))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    auto work = [&](unsigned int self) {
+        std::size_t first;
+        std::size_t last;
+
+        do
+        {
+            while (take(shares[self], grain, first, last))
+            {
+                body(first, last);
+            }
+        } while (steal_any(self));
+    };
+
+    std::vector<std::thread> workers;
+
+    for (unsigned int i = 1; i < threads; ++i)
+    {
+        workers.emplace_back(work, i);
+    }
+
+    work(0);
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
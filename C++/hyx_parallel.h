@@ -0,0 +1,24 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#ifndef HYX_PARALLEL_H
+#define HYX_PARALLEL_H
+
+#include <cstddef> // size_t
+#include <functional> // function
+
+
+namespace hyx
+{
+    [[nodiscard]] unsigned int default_threads() noexcept;
+
+    // calls body(first, last) over [0, count) in chunks of at most grain items on up to threads threads (0 picks default_threads()).
+    // every thread starts with an even share and steals the back half of another thread's share once its own runs out.
+    void parallel_for(std::size_t count, unsigned int threads, const std::function<void(std::size_t, std::size_t)>& body, std::size_t grain = 1);
+
+} // hyx
+
+#endif // !HYX_PARALLEL_H
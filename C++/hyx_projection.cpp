@@ -0,0 +1,360 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#include "hyx_projection.h"
+#include "hyx_kernel.h"
+#include "hyx_parallel.h"
+
+#include <algorithm> //min, max
+#include <cmath> //sqrt
+
+namespace
+{
+    // every chunk of trials draws from its own stream, whichever thread runs it.
+    constexpr std::size_t chunk_trials = 1024;
+
+    // trials simulated side by side; the inner loops run over these.
+    constexpr std::size_t batch_trials = 256;
+
+    std::uint64_t mix(std::uint64_t x) noexcept
+    {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+
+        return x ^ (x >> 31);
+    }
+
+    // share[t] for count trials of one stream: mean + deviation * z, kept within [0, 1].
+    // z is the sum of four uniforms, centred and scaled to unit variance, which is close to normal and cheap to vectorize.
+    void draw_shares(std::uint64_t key, std::size_t first, std::size_t count, double mean, double deviation, double* share) noexcept
+    {
+        constexpr double unit = 1.0 / 4294967296.0;
+        const double root3 = std::sqrt(3.0);
+
+        for (std::size_t t = 0; t < count; ++t)
+        {
+            std::uint64_t low = mix(key + 2 * (first + t));
+            std::uint64_t high = mix(key + 2 * (first + t) + 1);
+
+            double sum = (static_cast<double>(static_cast<std::uint32_t>(low)) + static_cast<double>(static_cast<std::uint32_t>(low >> 32))
+                + static_cast<double>(static_cast<std::uint32_t>(high)) + static_cast<double>(static_cast<std::uint32_t>(high >> 32))) * unit;
+
+            share[t] = std::min(1.0, std::max(0.0, mean + deviation * (sum - 2.0) * root3));
+        }
+    }
+}
+
+void hyx::Grade_projector::simulate(const Course& course, const std::vector<Category_forecast>& forecasts, std::uint64_t seed,
+    std::size_t first_trial, std::size_t last_trial, std::vector<std::size_t>& counts, double& grade_sum)
+{
+    const Compiled_scale& scale = *course.scale_;
+    std::size_t size = course.points_.size();
+    std::size_t no_band = scale.size();
+    std::size_t no_grade = scale.size() + 1;
+
+    if (course.is_withdrawn() || course.is_replaced() || not (course.has_good_weights() || course.is_point_based()))
+    {
+        counts[no_grade] += last_trial - first_trial;
+
+        return;
+    }
+
+    // one slot per remaining grade: the forecast it is drawn from.
+    std::vector<std::size_t> slots;
+    bool linear = true;
+
+    for (std::size_t f = 0; f < forecasts.size(); ++f)
+    {
+        const Category_forecast& forecast = forecasts[f];
+
+        if (forecast.category && forecast.category.index() < size && forecast.possible > 0)
+        {
+            const Course::Category& category = *course.points_[forecast.category.index()];
+
+            slots.insert(slots.end(), forecast.remaining, f);
+            linear = linear && category.drops <= 0 && category.replace.first <= 0;
+        }
+    }
+
+    // a first grade drawn for a category also sets what other categories replace with.
+    for (const auto& category : course.points_)
+    {
+        if (category->replace.first > 0 && category->replace_id && course.scores_.size(category->replace_id.index()) == 0)
+        {
+            for (const auto& forecast : forecasts)
+            {
+                linear = linear && not (forecast.category == category->replace_id && forecast.remaining != 0);
+            }
+        }
+    }
+
+    // the totals every trial starts from; drawn grades only add to them on the linear path.
+    std::vector<double> category_possible(size);
+    std::vector<bool> kept(size);
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        category_possible[i] = course.points_[i]->kept_possible;
+        kept[i] = course.points_[i]->has_kept;
+    }
+
+    for (std::size_t slot : slots)
+    {
+        category_possible[forecasts[slot].category.index()] += forecasts[slot].possible;
+        kept[forecasts[slot].category.index()] = true;
+    }
+
+    std::vector<double> weights;
+    std::vector<double> kept_earned;
+    std::vector<double> kept_possible;
+    double unused_weight = 0.0;
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        if (kept[i])
+        {
+            weights.push_back(course.points_[i]->weight);
+            kept_earned.push_back(course.points_[i]->kept_earned);
+            kept_possible.push_back(category_possible[i]);
+        }
+        else
+        {
+            unused_weight += course.points_[i]->weight;
+        }
+    }
+
+    bool point_based = course.is_point_based();
+
+    // grade = base + factor * (sum over slots of coefficient * share)
+    double base = 0.0;
+    double factor = 0.0;
+    std::vector<double> coefficients(slots.size());
+
+    if (point_based)
+    {
+        double earned = course.extra_;
+        double possible = 0.0;
+
+        for (std::size_t i = 0; i < kept_earned.size(); ++i)
+        {
+            earned += kept_earned[i];
+            possible += kept_possible[i];
+        }
+
+        base = earned / possible * 100;
+        factor = 100 / possible;
+
+        for (std::size_t s = 0; s < slots.size(); ++s)
+        {
+            coefficients[s] = forecasts[slots[s]].possible;
+        }
+    }
+    else
+    {
+        factor = 100 / (1 - unused_weight);
+        base = hyx::kernel::weighted_ratio_sum(weights.data(), kept_earned.data(), kept_possible.data(), weights.size()) * factor + course.extra_;
+
+        for (std::size_t s = 0; s < slots.size(); ++s)
+        {
+            std::uint32_t id = forecasts[slots[s]].category.index();
+
+            coefficients[s] = course.points_[id]->weight / category_possible[id] * forecasts[slots[s]].possible;
+        }
+    }
+
+    std::vector<double> shares(slots.size() * batch_trials);
+    std::vector<double> grades(batch_trials);
+    std::vector<bool> graded(batch_trials);
+
+    // the fallback's records and working space, grown on the first trial and reused by every later one.
+    std::vector<Course::Grade_record> records(slots.size());
+    Course::Projection_buffers buffers;
+
+    for (std::size_t chunk = first_trial / chunk_trials; chunk * chunk_trials < last_trial; ++chunk)
+    {
+        std::size_t chunk_first = std::max(first_trial, chunk * chunk_trials);
+        std::size_t chunk_last = std::min(last_trial, (chunk + 1) * chunk_trials);
+
+        for (std::size_t first = chunk_first; first < chunk_last; first += batch_trials)
+        {
+            std::size_t count = std::min(batch_trials, chunk_last - first);
+
+            for (std::size_t s = 0; s < slots.size(); ++s)
+            {
+                const Category_forecast& forecast = forecasts[slots[s]];
+
+                draw_shares(mix(seed ^ mix(chunk * 0x100000001B3ull + s)), first - chunk * chunk_trials, count, forecast.mean, forecast.deviation, shares.data() + s * batch_trials);
+            }
+
+            if (linear && not kept_earned.empty())
+            {
+                std::fill(grades.begin(), grades.begin() + count, 0.0);
+
+                for (std::size_t s = 0; s < slots.size(); ++s)
+                {
+                    const double* share = shares.data() + s * batch_trials;
+
+                    for (std::size_t t = 0; t < count; ++t)
+                    {
+                        grades[t] += coefficients[s] * share[t];
+                    }
+                }
+
+                for (std::size_t t = 0; t < count; ++t)
+                {
+                    grades[t] = base + factor * grades[t];
+                    graded[t] = true;
+                }
+            }
+            else
+            {
+                for (std::size_t t = 0; t < count; ++t)
+                {
+                    for (std::size_t s = 0; s < slots.size(); ++s)
+                    {
+                        const Category_forecast& forecast = forecasts[slots[s]];
+
+                        records[s] = { forecast.category, shares[s * batch_trials + t] * forecast.possible, forecast.possible };
+                    }
+
+                    graded[t] = course.project_grade(records, grades[t], buffers);
+                }
+            }
+
+            for (std::size_t t = 0; t < count; ++t)
+            {
+                if (not graded[t])
+                {
+                    ++counts[no_grade];
+                    continue;
+                }
+
+                std::uint8_t band = (point_based) ? scale.find(grades[t], course.base_points_) : scale.find(grades[t]);
+
+                ++counts[(band == Compiled_scale::npos) ? no_band : band];
+                grade_sum += grades[t];
+            }
+        }
+    }
+}
+
+hyx::Category_forecast hyx::Grade_projector::fit(const Course& course, Category_id category, std::size_t remaining, double possible)
+{
+    // running mean and variance of the shares of one category, or of all of them.
+    auto moments = [&](std::uint32_t first, std::uint32_t last, double& mean, double& deviation) {
+        std::size_t count = 0;
+        double sum = 0.0;
+        double squares = 0.0;
+
+        for (std::uint32_t id = first; id < last; ++id)
+        {
+            const double* earned = course.scores_.earned(id);
+            const double* scored = course.scores_.possible(id);
+
+            for (std::size_t i = 0; i < course.scores_.size(id); ++i)
+            {
+                if (scored[i] > 0)
+                {
+                    double share = earned[i] / scored[i];
+
+                    sum += share;
+                    squares += share * share;
+                    ++count;
+                }
+            }
+        }
+
+        if (count != 0)
+        {
+            mean = sum / count;
+            deviation = (count > 1) ? std::sqrt(std::max(0.0, (squares - sum * mean) / (count - 1))) : deviation;
+        }
+
+        return count;
+    };
+
+    // with nothing to go on at all, a wide guess around a C+.
+    double mean = 0.75;
+    double deviation = 0.15;
+
+    if (not category || category.index() >= course.points_.size()
+        || moments(category.index(), category.index() + 1, mean, deviation) < 2)
+    {
+        double course_mean = mean;
+
+        // the course's spread, but the category's own mean if it has one score.
+        moments(0, static_cast<std::uint32_t>(course.points_.size()), course_mean, deviation);
+
+        if (not category || category.index() >= course.points_.size() || course.scores_.size(category.index()) == 0)
+        {
+            mean = course_mean;
+        }
+    }
+
+    return { category, remaining, possible, mean, deviation };
+}
+
+hyx::Grade_projection hyx::Grade_projector::project(const Course& course, const std::vector<Category_forecast>& forecasts, std::size_t trials,
+    unsigned int threads, std::uint64_t seed)
+{
+    const Compiled_scale& scale = *course.scale_;
+    std::size_t chunks = (trials + chunk_trials - 1) / chunk_trials;
+
+    // one tally per chunk, added up in order so the sums do not depend on scheduling.
+    std::vector<std::vector<std::size_t>> counts(chunks, std::vector<std::size_t>(scale.size() + 2, 0));
+    std::vector<double> grade_sums(chunks, 0.0);
+
+    hyx::parallel_for(chunks, threads, [&](std::size_t first_chunk, std::size_t last_chunk) {
+        for (std::size_t chunk = first_chunk; chunk < last_chunk; ++chunk)
+        {
+            simulate(course, forecasts, seed, chunk * chunk_trials, std::min(trials, (chunk + 1) * chunk_trials), counts[chunk], grade_sums[chunk]);
+        }
+        });
+
+    Grade_projection projection{ {}, std::vector<double>(scale.size(), 0.0), 0.0, 0.0, trials };
+    std::vector<std::size_t> total(scale.size() + 2, 0);
+    double grade_sum = 0.0;
+
+    for (std::size_t chunk = 0; chunk < chunks; ++chunk)
+    {
+        for (std::size_t i = 0; i < total.size(); ++i)
+        {
+            total[i] += counts[chunk][i];
+        }
+
+        grade_sum += grade_sums[chunk];
+    }
+
+    for (std::size_t i = 0; i < scale.size(); ++i)
+    {
+        projection.letters.push_back(scale.get_letter(static_cast<std::uint8_t>(i)));
+        projection.probability[i] = (trials != 0) ? static_cast<double>(total[i]) / trials : 0.0;
+    }
+
+    std::size_t graded = trials - total[scale.size() + 1];
+
+    projection.no_letter = (trials != 0) ? static_cast<double>(total[scale.size()] + total[scale.size() + 1]) / trials : 0.0;
+    projection.mean_grade = (graded != 0) ? grade_sum / graded : -1;
+
+    return projection;
+}
+
+std::vector<hyx::Grade_projection> hyx::Grade_projector::project(const std::vector<const Course*>& courses,
+    const std::vector<std::vector<Category_forecast>>& forecasts, std::size_t trials, unsigned int threads, std::uint64_t seed)
+{
+    std::vector<Grade_projection> projections(courses.size());
+
+    hyx::parallel_for(courses.size(), threads, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i)
+        {
+            // keyed by CRN, so a course gets the same draws wherever it sits in the list.
+            projections[i] = project(*courses[i], forecasts[i], trials, 1, mix(seed ^ static_cast<std::uint64_t>(courses[i]->get_crn())));
+        }
+        });
+
+    return projections;
+}
@@ -0,0 +1,72 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#ifndef HYX_PROJECTION_H
+#define HYX_PROJECTION_H
+
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t
+#include <string> // string
+#include <vector> // vector
+
+#include "hyx_course.h"
+
+
+namespace hyx
+{
+    // the grades a category still has to give, and how their scores are expected to fall as shares of the possible points.
+    struct Category_forecast
+    {
+        Category_id category;
+        std::size_t remaining;
+        double possible;
+        double mean;
+        double deviation;
+    };
+
+    // how often each letter came out, in the band order of the course's scale.
+    struct Grade_projection
+    {
+        std::vector<std::string> letters;
+        std::vector<double> probability;
+
+        // share of trials that ended in no band of the scale, or without a grade at all.
+        double no_letter;
+
+        // average final grade over the trials that had one.
+        double mean_grade;
+
+        std::size_t trials;
+    };
+
+    // monte carlo projections of final letters. every trial draws the remaining scores and runs them through
+    // the course's weights, drops, replacements and scale; the course itself is never changed.
+    class Grade_projector
+    {
+    private:
+
+        // counts has a slot per band, then one for grades in no band and one for trials that end without a grade.
+        static void simulate(const Course& course, const std::vector<Category_forecast>& forecasts, std::uint64_t seed,
+            std::size_t first_trial, std::size_t last_trial, std::vector<std::size_t>& counts, double& grade_sum);
+
+    public:
+
+        // fits a forecast to the category's scores so far, to the whole course's when it has fewer than two.
+        [[nodiscard]] static Category_forecast fit(const Course& course, Category_id category, std::size_t remaining, double possible);
+
+        // trials are split into fixed chunks with a random stream each, so the result depends on seed but not on threads.
+        [[nodiscard]] static Grade_projection project(const Course& course, const std::vector<Category_forecast>& forecasts, std::size_t trials,
+            unsigned int threads = 1, std::uint64_t seed = 0);
+
+        // one projection per course, the courses spread over the threads; forecasts[i] belongs to courses[i].
+        [[nodiscard]] static std::vector<Grade_projection> project(const std::vector<const Course*>& courses,
+            const std::vector<std::vector<Category_forecast>>& forecasts, std::size_t trials, unsigned int threads = 1, std::uint64_t seed = 0);
+
+    };
+
+} // hyx
+
+#endif // !HYX_PROJECTION_H
@@ -0,0 +1,356 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#include "hyx_scale.h"
+
+#include <algorithm> //equal, find, sort, partition_point
+#include <cmath> //floor
+#include <iomanip> //setw, left
+#include <functional> //hash
+#include <tuple> //tie
+
+static std::size_t band_hash(std::size_t hash, const std::string& letter, int low, int high) noexcept;
+
+template <typename T>
+static bool higher_band(const T& lhs, const T& rhs) noexcept;
+
+// folds one band into the hash of the bands before it.
+std::size_t band_hash(std::size_t hash, const std::string& letter, int low, int high) noexcept
+{
+    for (std::size_t value : { std::hash<std::string>()(letter), std::hash<int>()(low), std::hash<int>()(high) })
+    {
+        hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    }
+
+    return hash;
+}
+
+// highest band first; ties are broken by letter so the order never depends on the map.
+template <typename T>
+bool higher_band(const T& lhs, const T& rhs) noexcept
+{
+    return std::tie(rhs.second.first, rhs.second.second, lhs.first) < std::tie(lhs.second.first, lhs.second.second, rhs.first);
+}
+
+void hyx::Compiled_scale::resolve_points(const Grade_points& points)
+{
+    this->points_.clear();
+
+    for (const auto& letter : this->letters_)
+    {
+        auto itr = points.find(letter);
+
+        this->points_.push_back((itr != points.end()) ? itr->second : -1.0);
+    }
+}
+
+hyx::Compiled_scale::Compiled_scale(const Grade_scale& scale, const Grade_points& points) :
+    letters_(),
+    bands_(),
+    points_(),
+    percent_()
+{
+    this->percent_.fill(npos);
+
+    if (scale.size() > max_bands)
+    {
+        return;
+    }
+
+    std::vector<std::pair<std::string, std::pair<int, int>>> sorted(scale.begin(), scale.end());
+
+    std::sort(sorted.begin(), sorted.end(), higher_band<std::pair<std::string, std::pair<int, int>>>);
+
+    for (const auto& itr : sorted)
+    {
+        this->letters_.push_back(itr.first);
+        this->bands_.push_back({ itr.second.first, itr.second.second });
+    }
+
+    for (int perc = 0; perc <= 100; ++perc)
+    {
+        for (std::size_t i = 0; i < this->bands_.size(); ++i)
+        {
+            if (this->bands_[i].low <= perc && perc <= this->bands_[i].high)
+            {
+                this->percent_[perc] = static_cast<std::uint8_t>(i);
+                break;
+            }
+        }
+    }
+
+    this->resolve_points(points);
+}
+
+std::size_t hyx::Compiled_scale::size() const noexcept
+{
+    return this->bands_.size();
+}
+
+const std::string& hyx::Compiled_scale::get_letter(std::uint8_t band) const noexcept
+{
+    return this->letters_[band];
+}
+
+const hyx::Compiled_scale::Band& hyx::Compiled_scale::get_band(std::uint8_t band) const noexcept
+{
+    return this->bands_[band];
+}
+
+double hyx::Compiled_scale::get_points(std::uint8_t band) const noexcept
+{
+    return this->points_[band];
+}
+
+hyx::Grade_scale hyx::Compiled_scale::get_grade_scale() const
+{
+    Grade_scale scale;
+
+    for (std::size_t i = 0; i < this->bands_.size(); ++i)
+    {
+        scale.emplace(this->letters_[i], std::pair<int, int>(this->bands_[i].low, this->bands_[i].high));
+    }
+
+    return scale;
+}
+
+std::uint8_t hyx::Compiled_scale::find(double grade) const noexcept
+{
+    double floor_grade = std::floor(grade);
+
+    if (floor_grade >= 0 && floor_grade <= 100)
+    {
+        return this->percent_[static_cast<std::size_t>(floor_grade)];
+    }
+
+    auto itr = std::partition_point(this->bands_.begin(), this->bands_.end(), [&](const Band& band) { return floor_grade < band.low; });
+
+    return (itr != this->bands_.end() && floor_grade <= itr->high) ? static_cast<std::uint8_t>(itr - this->bands_.begin()) : npos;
+}
+
+std::uint8_t hyx::Compiled_scale::find(double grade, double base_points) const noexcept
+{
+    // multiplied out rather than divided, so a whole grade right on the edge of a band is not lost between two bands to rounding.
+    double floor_points = std::floor(grade) * base_points;
+
+    auto itr = std::partition_point(this->bands_.begin(), this->bands_.end(), [&](const Band& band) { return floor_points < band.low * 100.0; });
+
+    return (itr != this->bands_.end() && floor_points <= itr->high * 100.0) ? static_cast<std::uint8_t>(itr - this->bands_.begin()) : npos;
+}
+
+std::size_t hyx::Compiled_scale::hash() const noexcept
+{
+    std::size_t hash = 0;
+
+    for (std::size_t i = 0; i < this->bands_.size(); ++i)
+    {
+        hash = band_hash(hash, this->letters_[i], this->bands_[i].low, this->bands_[i].high);
+    }
+
+    return hash;
+}
+
+bool hyx::Compiled_scale::matches(const Grade_scale& scale, const Grade_points& points) const noexcept
+{
+    if (scale.size() != this->bands_.size())
+    {
+        return false;
+    }
+
+    for (const auto& itr : scale)
+    {
+        auto letter = std::find(this->letters_.begin(), this->letters_.end(), itr.first);
+
+        if (letter == this->letters_.end())
+        {
+            return false;
+        }
+
+        std::size_t i = static_cast<std::size_t>(letter - this->letters_.begin());
+        auto points_itr = points.find(itr.first);
+
+        if (this->bands_[i].low != itr.second.first || this->bands_[i].high != itr.second.second
+            || this->points_[i] != ((points_itr != points.end()) ? points_itr->second : -1.0))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool hyx::Compiled_scale::operator==(const Compiled_scale& other) const noexcept
+{
+    return this->letters_ == other.letters_ && this->points_ == other.points_ && std::equal(this->bands_.begin(), this->bands_.end(), other.bands_.begin(), other.bands_.end(),
+        [](const Band& lhs, const Band& rhs) { return lhs.low == rhs.low && lhs.high == rhs.high; });
+}
+
+bool hyx::Compiled_scale::operator!=(const Compiled_scale& other) const noexcept
+{
+    return not (*this == other);
+}
+
+hyx::Scale_registry& hyx::Scale_registry::instance()
+{
+    static Scale_registry registry;
+
+    return registry;
+}
+
+std::shared_ptr<const hyx::Compiled_scale> hyx::Scale_registry::intern(const Grade_scale& scale, const Grade_points& points)
+{
+    if (scale.size() > Compiled_scale::max_bands)
+    {
+        return this->intern(Compiled_scale(scale, points));
+    }
+
+    // hashed in the order the scale compiles to, without compiling it.
+    std::vector<const Grade_scale::value_type*> sorted;
+    std::size_t hash = 0;
+
+    sorted.reserve(scale.size());
+
+    for (const auto& itr : scale)
+    {
+        sorted.push_back(&itr);
+    }
+
+    std::sort(sorted.begin(), sorted.end(), [](const auto* lhs, const auto* rhs) { return higher_band(*lhs, *rhs); });
+
+    for (const auto* itr : sorted)
+    {
+        hash = band_hash(hash, itr->first, itr->second.first, itr->second.second);
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(this->lock_);
+
+        auto range = this->scales_.equal_range(hash);
+
+        for (auto itr = range.first; itr != range.second; ++itr)
+        {
+            if (itr->second->matches(scale, points))
+            {
+                return itr->second;
+            }
+        }
+    }
+
+    return this->intern(Compiled_scale(scale, points));
+}
+
+std::shared_ptr<const hyx::Compiled_scale> hyx::Scale_registry::intern(const Compiled_scale& scale)
+{
+    std::size_t hash = scale.hash();
+
+    std::lock_guard<std::mutex> guard(this->lock_);
+
+    auto range = this->scales_.equal_range(hash);
+
+    for (auto itr = range.first; itr != range.second; ++itr)
+    {
+        if (*itr->second == scale)
+        {
+            return itr->second;
+        }
+    }
+
+    return this->scales_.emplace(hash, std::make_shared<const Compiled_scale>(scale))->second;
+}
+
+std::size_t hyx::Scale_registry::size() const
+{
+    std::lock_guard<std::mutex> guard(this->lock_);
+
+    return this->scales_.size();
+}
+
+hyx::Shared_scale::Shared_scale(const Grade_scale& scale, const Grade_points& points) :
+    scale_(Scale_registry::instance().intern(scale, points))
+{
+}
+
+hyx::Shared_scale::Shared_scale(const Compiled_scale& scale) :
+    scale_(Scale_registry::instance().intern(scale))
+{
+}
+
+const hyx::Compiled_scale& hyx::Shared_scale::operator*() const noexcept
+{
+    return *this->scale_;
+}
+
+const hyx::Compiled_scale* hyx::Shared_scale::operator->() const noexcept
+{
+    return this->scale_.get();
+}
+
+bool hyx::Shared_scale::operator==(const Shared_scale& other) const noexcept
+{
+    return this->scale_ == other.scale_;
+}
+
+bool hyx::Shared_scale::operator!=(const Shared_scale& other) const noexcept
+{
+    return this->scale_ != other.scale_;
+}
+
+const hyx::Shared_scale& hyx::scale::shared::STD()
+{
+    static const Shared_scale scale(hyx::scale::table::STD);
+
+    return scale;
+}
+
+const hyx::Shared_scale& hyx::scale::shared::G11()
+{
+    static const Shared_scale scale(hyx::scale::table::G11);
+
+    return scale;
+}
+
+const hyx::Shared_scale& hyx::scale::shared::U12()
+{
+    static const Shared_scale scale(hyx::scale::table::U12);
+
+    return scale;
+}
+
+const hyx::Shared_scale& hyx::scale::shared::U11()
+{
+    static const Shared_scale scale(hyx::scale::table::U11);
+
+    return scale;
+}
+
+const hyx::Shared_scale& hyx::scale::shared::PF()
+{
+    static const Shared_scale scale(hyx::scale::table::PF);
+
+    return scale;
+}
+
+std::ostream& hyx::operator<<(std::ostream& os, const hyx::Grade_scale& scale) noexcept
+{
+    for (auto& itr : scale)
+    {
+        os << std::left << std::setw(2) << itr.first << ": [" << itr.second.first << "-" << itr.second.second << "]\n";
+    }
+
+    return os;
+}
+
+std::ostream& hyx::operator<<(std::ostream& os, const hyx::Compiled_scale& scale) noexcept
+{
+    for (std::size_t i = 0; i < scale.size(); ++i)
+    {
+        const Compiled_scale::Band& band = scale.get_band(static_cast<std::uint8_t>(i));
+
+        os << std::left << std::setw(2) << scale.get_letter(static_cast<std::uint8_t>(i)) << ": [" << band.low << "-" << band.high << "]\n";
+    }
+
+    return os;
+}
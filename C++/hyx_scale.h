@@ -0,0 +1,333 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#ifndef HYX_SCALE_H
+#define HYX_SCALE_H
+
+#include <array> // array
+#include <climits> // INT_MAX
+#include <cstddef> // size_t
+#include <cstdint> // uint8_t, UINT8_MAX
+#include <memory> // shared_ptr
+#include <mutex> // mutex
+#include <ostream> // ostream
+#include <string> // string
+#include <string_view> // string_view
+#include <unordered_map> // unordered_map
+#include <utility> // pair
+#include <vector> // vector
+
+
+namespace hyx
+{
+    typedef std::unordered_map<std::string, std::pair<int, int>> Grade_scale;
+
+    // letter; quality points per unit
+    typedef std::unordered_map<std::string, double> Grade_points;
+
+    // letter, lowest grade, highest grade
+    struct Scale_band
+    {
+        std::string_view letter;
+        int low;
+        int high;
+    };
+
+    // bands ordered from the highest one down, and the band of every whole percentage (UINT8_MAX if none).
+    template <std::size_t N>
+    struct Scale_table
+    {
+        std::array<Scale_band, N> bands;
+        std::array<std::uint8_t, 101> percent;
+    };
+
+    template <std::size_t N>
+    [[nodiscard]] constexpr Scale_table<N> make_scale_table(std::array<Scale_band, N> bands) noexcept
+    {
+        static_assert(N < UINT8_MAX, "a band index must fit in a byte below UINT8_MAX");
+
+        for (std::size_t i = 1; i < N; ++i)
+        {
+            Scale_band band = bands[i];
+            std::size_t j = i;
+
+            for (; j > 0 && bands[j - 1].low < band.low; --j)
+            {
+                bands[j] = bands[j - 1];
+            }
+
+            bands[j] = band;
+        }
+
+        Scale_table<N> table{ bands, {} };
+
+        for (int perc = 0; perc <= 100; ++perc)
+        {
+            table.percent[perc] = UINT8_MAX;
+
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                if (bands[i].low <= perc && perc <= bands[i].high)
+                {
+                    table.percent[perc] = static_cast<std::uint8_t>(i);
+                    break;
+                }
+            }
+        }
+
+        return table;
+    }
+
+    template <std::size_t N>
+    [[nodiscard]] Grade_scale to_grade_scale(const Scale_table<N>& table)
+    {
+        Grade_scale scale;
+
+        for (const auto& band : table.bands)
+        {
+            scale.emplace(band.letter, std::pair<int, int>(band.low, band.high));
+        }
+
+        return scale;
+    }
+
+    namespace scale
+    {
+        namespace table
+        {
+            inline constexpr auto STD = make_scale_table<5>({ {
+                {"A", 90, INT_MAX},
+                {"B", 80, 89},
+                {"C", 70, 79},
+                {"D", 60, 69},
+                {"F", 0, 59}
+                } });
+
+            inline constexpr auto G11 = make_scale_table<12>({ {
+                {"A", 90, INT_MAX},
+                {"A-", 85, 89},
+                {"B+", 80, 84},
+                {"B", 75, 79},
+                {"B-", 70, 74},
+                {"C+", 67, 69},
+                {"C", 64, 66},
+                {"C-", 60, 63},
+                {"D+", 57, 59},
+                {"D", 54, 56},
+                {"D-", 50, 53},
+                {"F", 0, 49}
+                } });
+
+            inline constexpr auto U12 = make_scale_table<10>({ {
+                {"A", 93, INT_MAX},
+                {"A-", 90, 92},
+                {"B+", 87, 89},
+                {"B", 83, 86},
+                {"B-", 80, 82},
+                {"C+", 77, 79},
+                {"C", 73, 76},
+                {"C-", 70, 72},
+                {"D", 60, 69},
+                {"F", 0, 59}
+                } });
+
+            inline constexpr auto U11 = make_scale_table<12>({ {
+                {"A", 93, INT_MAX},
+                {"A-", 90, 92},
+                {"B+", 87, 89},
+                {"B", 83, 86},
+                {"B-", 80, 82},
+                {"C+", 77, 79},
+                {"C", 73, 76},
+                {"C-", 70, 72},
+                {"D+", 67, 69},
+                {"D", 63, 66},
+                {"D-", 60, 62},
+                {"F", 0, 59}
+                } });
+
+            inline constexpr auto PF = make_scale_table<2>({ {
+                {"P", 60, INT_MAX},
+                {"NP", 0, 59}
+                } });
+        }
+
+        inline Grade_scale STD = to_grade_scale(table::STD);
+
+        inline Grade_scale G11 = to_grade_scale(table::G11);
+
+        inline Grade_scale U12 = to_grade_scale(table::U12);
+
+        inline Grade_scale U11 = to_grade_scale(table::U11);
+
+        inline Grade_scale PF = to_grade_scale(table::PF);
+    }
+
+    namespace grade_points
+    {
+        inline const Grade_points STD({
+            {"A+", 4.0},
+            {"A", 4.0},
+            {"A-", 3.7},
+            {"B+", 3.3},
+            {"B", 3.0},
+            {"B-", 2.7},
+            {"C+", 2.3},
+            {"C", 2.0},
+            {"C-", 1.7},
+            {"D+", 1.3},
+            {"D", 1.0},
+            {"D-", 0.7},
+            {"F", 0.0}
+            });
+    }
+
+    // a Grade_scale ordered from the highest band down, with a direct lookup for whole percentages
+    // and the quality points of every band (-1 for letters that carry none, like P and NP).
+    // bands are indexed by a byte, so a scale with more than max_bands bands is rejected and compiles to no bands at all.
+    class Compiled_scale
+    {
+    public:
+        static constexpr std::uint8_t npos = UINT8_MAX;
+
+        static constexpr std::size_t max_bands = npos;
+
+        // lowest grade, highest grade
+        struct Band
+        {
+            int low;
+            int high;
+        };
+
+    private:
+
+        std::vector<std::string> letters_;
+        std::vector<Band> bands_;
+        std::vector<double> points_;
+        std::array<std::uint8_t, 101> percent_;
+
+        void resolve_points(const Grade_points& points);
+
+    public:
+
+        Compiled_scale(const Grade_scale& scale, const Grade_points& points = grade_points::STD);
+
+        template <std::size_t N>
+        Compiled_scale(const Scale_table<N>& table, const Grade_points& points = grade_points::STD) :
+            letters_(),
+            bands_(),
+            points_(),
+            percent_(table.percent)
+        {
+            for (const auto& band : table.bands)
+            {
+                this->letters_.emplace_back(band.letter);
+                this->bands_.push_back({ band.low, band.high });
+            }
+
+            this->resolve_points(points);
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept;
+
+        [[nodiscard]] const std::string& get_letter(std::uint8_t band) const noexcept;
+
+        [[nodiscard]] const Band& get_band(std::uint8_t band) const noexcept;
+
+        [[nodiscard]] double get_points(std::uint8_t band) const noexcept;
+
+        [[nodiscard]] Grade_scale get_grade_scale() const;
+
+        // the same value for equal scales, whatever order their bands were given in; bands are hashed highest first,
+        // so the same cutoffs under different letters hash apart.
+        [[nodiscard]] std::size_t hash() const noexcept;
+
+        [[nodiscard]] bool matches(const Grade_scale& scale, const Grade_points& points) const noexcept;
+
+        // band of a percentage grade, or npos.
+        [[nodiscard]] std::uint8_t find(double grade) const noexcept;
+
+        // band of a grade in a course worth base_points, or npos.
+        [[nodiscard]] std::uint8_t find(double grade, double base_points) const noexcept;
+
+        bool operator==(const Compiled_scale& other) const noexcept;
+
+        bool operator!=(const Compiled_scale& other) const noexcept;
+
+    };
+
+    // interned, immutable scales; equal scales share one object.
+    // scales are never freed, so the registry grows with every distinct scale seen while the program runs.
+    class Scale_registry
+    {
+    private:
+
+        mutable std::mutex lock_;
+        std::unordered_multimap<std::size_t, std::shared_ptr<const Compiled_scale>> scales_;
+
+        Scale_registry() = default;
+
+    public:
+
+        [[nodiscard]] static Scale_registry& instance();
+
+        [[nodiscard]] std::shared_ptr<const Compiled_scale> intern(const Grade_scale& scale, const Grade_points& points);
+
+        [[nodiscard]] std::shared_ptr<const Compiled_scale> intern(const Compiled_scale& scale);
+
+        [[nodiscard]] std::size_t size() const;
+
+    };
+
+    // a handle to an interned scale; two handles are equal when they point at the same scale.
+    class Shared_scale
+    {
+    private:
+
+        std::shared_ptr<const Compiled_scale> scale_;
+
+    public:
+
+        Shared_scale(const Grade_scale& scale, const Grade_points& points = grade_points::STD);
+
+        Shared_scale(const Compiled_scale& scale);
+
+        template <std::size_t N>
+        Shared_scale(const Scale_table<N>& table, const Grade_points& points = grade_points::STD) :
+            scale_(Scale_registry::instance().intern(Compiled_scale(table, points)))
+        {
+        }
+
+        [[nodiscard]] const Compiled_scale& operator*() const noexcept;
+
+        [[nodiscard]] const Compiled_scale* operator->() const noexcept;
+
+        bool operator==(const Shared_scale& other) const noexcept;
+
+        bool operator!=(const Shared_scale& other) const noexcept;
+
+    };
+
+    namespace scale::shared
+    {
+        [[nodiscard]] const Shared_scale& STD();
+
+        [[nodiscard]] const Shared_scale& G11();
+
+        [[nodiscard]] const Shared_scale& U12();
+
+        [[nodiscard]] const Shared_scale& U11();
+
+        [[nodiscard]] const Shared_scale& PF();
+    }
+
+    std::ostream& operator<< (std::ostream& os, const hyx::Grade_scale& scale) noexcept;
+
+    std::ostream& operator<< (std::ostream& os, const hyx::Compiled_scale& scale) noexcept;
+
+} // hyx
+
+#endif // !HYX_SCALE_H
@@ -0,0 +1,177 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#include "hyx_schedule.h"
+
+#include <charconv> //to_chars
+
+namespace
+{
+    bool is_leap(int year) noexcept
+    {
+        return year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+    }
+
+    void append_two_digits(std::string& out, int value)
+    {
+        out.push_back(static_cast<char>('0' + value / 10));
+        out.push_back(static_cast<char>('0' + value % 10));
+    }
+}
+
+hyx::Schedule hyx::Schedule::pack(const std::array<bool, 8>& week_days, const std::array<int, 3>& start_date, const std::array<int, 3>& end_date,
+    const std::array<int, 2>& start_time, const std::array<int, 2>& end_time) noexcept
+{
+    std::uint8_t days = 0;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        days |= static_cast<std::uint8_t>(week_days[i] << i);
+    }
+
+    return {
+        schedule::days_from_civil(start_date[0], start_date[1], start_date[2]),
+        schedule::days_from_civil(end_date[0], end_date[1], end_date[2]),
+        schedule::pack_time(start_time[0], start_time[1]),
+        schedule::pack_time(end_time[0], end_time[1]),
+        days
+    };
+}
+
+// days since 1970-01-01 by counting whole 400 year eras from 0000-03-01, so leap days fall at the end of each year.
+std::int32_t hyx::schedule::days_from_civil(int year, int month, int day) noexcept
+{
+    static constexpr int month_days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+    // wide enough for any date in the past or future of a gradebook, and far from overflowing.
+    if (year < -1000000 || year > 1000000 || month < 1 || month > 12 || day < 1
+        || day > month_days[month - 1] + (month == 2 && is_leap(year)))
+    {
+        return Schedule::no_date;
+    }
+
+    year -= (month <= 2);
+
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int year_of_era = year - era * 400;
+    int day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+
+    return era * 146097 + day_of_era - 719468;
+}
+
+std::array<int, 3> hyx::schedule::civil_from_days(std::int32_t day) noexcept
+{
+    if (day == Schedule::no_date)
+    {
+        return { 0, 0, 0 };
+    }
+
+    day += 719468;
+
+    int era = (day >= 0 ? day : day - 146096) / 146097;
+    int day_of_era = day - era * 146097;
+    int year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    int day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    int shifted_month = (5 * day_of_year + 2) / 153;
+    int month = (shifted_month < 10) ? shifted_month + 3 : shifted_month - 9;
+
+    return { year_of_era + era * 400 + (month <= 2), month, day_of_year - (153 * shifted_month + 2) / 5 + 1 };
+}
+
+int hyx::schedule::weekday(std::int32_t day) noexcept
+{
+    // 1970-01-01 was a thursday.
+    return ((day + 4) % 7 + 7) % 7;
+}
+
+bool hyx::schedule::has_weekday(std::int32_t first_day, std::int32_t last_day, int weekday) noexcept
+{
+    if (first_day > last_day)
+    {
+        return false;
+    }
+
+    if (first_day == INT32_MIN || last_day == INT32_MAX || last_day - first_day >= 6)
+    {
+        return true;
+    }
+
+    return (weekday - schedule::weekday(first_day) + 7) % 7 <= last_day - first_day;
+}
+
+std::uint16_t hyx::schedule::pack_time(int hour, int minute) noexcept
+{
+    return (hour < 0 || hour > 23 || minute < 0 || minute > 59) ? Schedule::no_time : static_cast<std::uint16_t>(hour * 60 + minute);
+}
+
+std::array<int, 2> hyx::schedule::unpack_time(std::uint16_t minute) noexcept
+{
+    if (minute == Schedule::no_time)
+    {
+        return { -1, -1 };
+    }
+
+    return { minute / 60, minute % 60 };
+}
+
+std::array<bool, 8> hyx::schedule::unpack_week_days(std::uint8_t week_days) noexcept
+{
+    std::array<bool, 8> days{};
+
+    for (int i = 0; i < 8; ++i)
+    {
+        days[i] = (week_days >> i) & 1;
+    }
+
+    return days;
+}
+
+void hyx::schedule::append_week_days(std::string& out, std::uint8_t week_days)
+{
+    static constexpr char LUT_week_days[] = { 'U', 'M', 'T', 'W', 'R', 'F', 'S' };
+
+    // if we start with monday, sunday goes last.
+    int first = (week_days & Schedule::monday_first) ? 1 : 0;
+
+    for (int i = first; i < first + 7; ++i)
+    {
+        out.push_back(((week_days >> (i % 7)) & 1) ? LUT_week_days[i % 7] : '-');
+    }
+}
+
+void hyx::schedule::append_ISO_date(std::string& out, std::int32_t day)
+{
+    if (day == Schedule::no_date)
+    {
+        return;
+    }
+
+    std::array<int, 3> date = civil_from_days(day);
+    char buff[16];
+
+    out.append(buff, std::to_chars(buff, buff + sizeof(buff), date[0]).ptr);
+    out.push_back('-');
+    append_two_digits(out, date[1]);
+    out.push_back('-');
+    append_two_digits(out, date[2]);
+}
+
+void hyx::schedule::append_clock_time(std::string& out, std::uint16_t minute)
+{
+    if (minute == Schedule::no_time)
+    {
+        return;
+    }
+
+    int hour = minute / 60;
+
+    // 12 hour clock: 00:30 is 12:30 AM and 12:30 is 12:30 PM.
+    append_two_digits(out, (hour % 12 == 0) ? 12 : hour % 12);
+    out.push_back(':');
+    append_two_digits(out, minute % 60);
+    out.append((hour < 12) ? " AM" : " PM");
+}
@@ -0,0 +1,98 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#ifndef HYX_SCHEDULE_H
+#define HYX_SCHEDULE_H
+
+#include <array> // array
+#include <chrono> // duration, time_point, system_clock
+#include <climits> // INT32_MIN
+#include <cstdint> // int32_t, uint8_t, uint16_t, UINT16_MAX
+#include <ratio> // ratio
+#include <string> // string
+
+
+namespace hyx
+{
+    using Days = std::chrono::duration<std::int32_t, std::ratio<86400>>;
+
+    // a calendar day as a count of days since 1970-01-01.
+    using Date = std::chrono::time_point<std::chrono::system_clock, Days>;
+
+    // when a course meets, packed into four words: dates as days since 1970-01-01 and times as minutes since midnight.
+    struct Schedule
+    {
+        // a date that is not a real calendar day, and a time that was not given or is out of range.
+        static constexpr std::int32_t no_date = INT32_MIN;
+        static constexpr std::uint16_t no_time = UINT16_MAX;
+
+        // week_days has bit 0 for sunday through bit 6 for saturday; bit 7 lists the week from monday.
+        static constexpr std::uint8_t monday_first = 0x80;
+
+        std::int32_t start_day;
+        std::int32_t end_day;
+        std::uint16_t start_minute;
+        std::uint16_t end_minute;
+        std::uint8_t week_days;
+
+        // week_days is indexed the same way as the bits, dates are {year, month, day} and times {hour, minute}.
+        [[nodiscard]] static Schedule pack(const std::array<bool, 8>& week_days, const std::array<int, 3>& start_date, const std::array<int, 3>& end_date,
+            const std::array<int, 2>& start_time, const std::array<int, 2>& end_time) noexcept;
+
+        // weekday is 0 for sunday through 6 for saturday.
+        [[nodiscard]] bool meets_on(int weekday) const noexcept
+        {
+            return (this->week_days >> weekday) & 1;
+        }
+
+        [[nodiscard]] Date start_date() const noexcept
+        {
+            return Date(Days(this->start_day));
+        }
+
+        [[nodiscard]] Date end_date() const noexcept
+        {
+            return Date(Days(this->end_day));
+        }
+
+    };
+
+} // hyx
+
+namespace hyx::schedule
+{
+    // Schedule::no_date unless month and day name a real day of the year.
+    [[nodiscard]] std::int32_t days_from_civil(int year, int month, int day) noexcept;
+
+    // {year, month, day}; {0, 0, 0} for Schedule::no_date.
+    [[nodiscard]] std::array<int, 3> civil_from_days(std::int32_t day) noexcept;
+
+    // 0 for sunday through 6 for saturday.
+    [[nodiscard]] int weekday(std::int32_t day) noexcept;
+
+    // whether [first_day, last_day] holds a day that falls on weekday; an end of INT32_MIN or INT32_MAX is open.
+    [[nodiscard]] bool has_weekday(std::int32_t first_day, std::int32_t last_day, int weekday) noexcept;
+
+    // Schedule::no_time unless both are on a 24 hour clock.
+    [[nodiscard]] std::uint16_t pack_time(int hour, int minute) noexcept;
+
+    // {hour, minute}; {-1, -1} for Schedule::no_time.
+    [[nodiscard]] std::array<int, 2> unpack_time(std::uint16_t minute) noexcept;
+
+    [[nodiscard]] std::array<bool, 8> unpack_week_days(std::uint8_t week_days) noexcept;
+
+    // "UMTWRFS" with a '-' for every day without a meeting, from monday when the week is listed that way.
+    void append_week_days(std::string& out, std::uint8_t week_days);
+
+    // "2021-09-01"; nothing for Schedule::no_date.
+    void append_ISO_date(std::string& out, std::int32_t day);
+
+    // "09:05 AM"; nothing for Schedule::no_time.
+    void append_clock_time(std::string& out, std::uint16_t minute);
+
+} // hyx::schedule
+
+#endif // !HYX_SCHEDULE_H
@@ -0,0 +1,731 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#include "hyx_snapshot.h"
+
+#include <cerrno> //errno, EINTR
+#include <cstdio> //rename
+#include <cstdlib> //mkstemp
+#include <cstring> //memcmp, memcpy
+#include <unordered_map> //unordered_map
+#include <fcntl.h> //open
+#include <sys/mman.h> //mmap, munmap
+#include <sys/stat.h> //fstat, fchmod
+#include <unistd.h> //write, fsync, close, unlink
+
+namespace
+{
+    struct Pool
+    {
+        std::string data;
+
+        hyx::snapshot::String_ref add(std::string_view text)
+        {
+            hyx::snapshot::String_ref ref{ this->data.size(), text.size() };
+
+            this->data.append(text);
+
+            return ref;
+        }
+    };
+
+    bool write_all(int fd, const void* data, std::size_t size) noexcept
+    {
+        const char* bytes = static_cast<const char*>(data);
+
+        while (size > 0)
+        {
+            ssize_t written = ::write(fd, bytes, size);
+
+            if (written < 0)
+            {
+                if (errno != EINTR)
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                bytes += written;
+                size -= static_cast<std::size_t>(written);
+            }
+        }
+
+        return true;
+    }
+
+    // returns the offset of a section of count records and moves offset past it.
+    std::uint64_t place(std::uint64_t& offset, std::size_t count, std::size_t record) noexcept
+    {
+        std::uint64_t at = offset;
+
+        offset += count * record;
+
+        return at;
+    }
+
+    // whether count records of the given size and alignment fit in the file at offset.
+    bool fits(std::size_t file_size, std::uint64_t offset, std::uint64_t count, std::size_t record, std::size_t align) noexcept
+    {
+        return offset % align == 0 && offset <= file_size && count <= (file_size - offset) / record;
+    }
+
+    bool within(std::uint64_t first, std::uint64_t count, std::uint64_t total) noexcept
+    {
+        return first <= total && count <= total - first;
+    }
+
+    // flushes the directory holding path, so a file renamed into it survives a crash.
+    bool sync_directory(const std::string& path) noexcept
+    {
+        std::size_t slash = path.rfind('/');
+        std::string directory = (slash == std::string::npos) ? "." : (slash == 0) ? "/" : path.substr(0, slash);
+        int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        bool good = ::fsync(fd) == 0;
+
+        return (::close(fd) == 0) && good;
+    }
+}
+
+hyx::Course_view::Course_view(const Snapshot* snapshot, const snapshot::Course_record* record) noexcept :
+    snapshot_(snapshot),
+    record_(record)
+{
+}
+
+const hyx::snapshot::Category_record& hyx::Course_view::category(std::size_t index) const noexcept
+{
+    return this->snapshot_->category(this->record_->first_category + index);
+}
+
+hyx::Shared_scale hyx::Course_view::get_shared_scale() const
+{
+    const snapshot::Scale_record& record = this->snapshot_->scale(this->record_->scale);
+
+    Grade_scale scale;
+    Grade_points points;
+
+    for (std::uint64_t i = 0; i < record.band_count; ++i)
+    {
+        const snapshot::Band_record& band = this->snapshot_->band(record.first_band + i);
+        std::string letter(this->snapshot_->string(band.letter));
+
+        if (band.points >= 0)
+        {
+            points.emplace(letter, band.points);
+        }
+
+        scale.emplace(letter, std::pair<int, int>(band.low, band.high));
+    }
+
+    // equal scales are interned, so this finds the one already shared by live courses.
+    return Shared_scale(scale, points);
+}
+
+void hyx::Course_view::restore(Course& course) const
+{
+    for (std::size_t i = 0; i < this->get_category_count(); ++i)
+    {
+        const snapshot::Category_record& record = this->category(i);
+
+        Category_id id = course.add_category(std::string(this->snapshot_->string(record.name)), record.weight, record.drops,
+            { record.replace_count, std::string(this->snapshot_->string(record.replace_name)) });
+
+        const double* earned = this->get_earned(i);
+        const double* possible = this->get_possible(i);
+
+        course.scores_.reserve(id.index(), record.score_count);
+
+        for (std::uint64_t j = 0; j < record.score_count; ++j)
+        {
+            course.scores_.push_back(id.index(), earned[j], possible[j]);
+        }
+    }
+
+    for (std::uint64_t i = 0; i < this->record_->book_count; ++i)
+    {
+        course.info_.write().books.emplace_back(this->snapshot_->string(this->snapshot_->book(this->record_->first_book + i)));
+    }
+
+    course.extra_ = this->record_->extra;
+    course.base_points_ = this->record_->base_points;
+
+    course.recompute();
+
+    // the saved results win, so statuses and their grades come back exactly as they were.
+    course.grade_ = this->record_->grade;
+    course.band_ = this->record_->band;
+    course.grade_points_ = this->record_->grade_points;
+    course.status_ = static_cast<Course_status>(this->record_->status);
+}
+
+std::string_view hyx::Course_view::get_name() const noexcept
+{
+    return this->snapshot_->string(this->record_->name);
+}
+
+long hyx::Course_view::get_crn() const noexcept
+{
+    return static_cast<long>(this->record_->crn);
+}
+
+int hyx::Course_view::get_units() const noexcept
+{
+    return this->record_->units;
+}
+
+std::string_view hyx::Course_view::get_institution() const noexcept
+{
+    return this->snapshot_->string(this->record_->institution);
+}
+
+std::string_view hyx::Course_view::get_location() const noexcept
+{
+    return this->snapshot_->string(this->record_->location);
+}
+
+std::string_view hyx::Course_view::get_instructor() const noexcept
+{
+    return this->snapshot_->string(this->record_->instructor);
+}
+
+std::string_view hyx::Course_view::get_details() const noexcept
+{
+    return this->snapshot_->string(this->record_->details);
+}
+
+double hyx::Course_view::get_grade() const noexcept
+{
+    return this->record_->grade;
+}
+
+std::string_view hyx::Course_view::get_letter() const noexcept
+{
+    static constexpr std::string_view status_letters[] = { "", "W", "R", "I" };
+
+    if (this->record_->status != static_cast<std::uint8_t>(Course_status::active) || this->record_->band == Compiled_scale::npos)
+    {
+        return status_letters[this->record_->status];
+    }
+
+    const snapshot::Scale_record& scale = this->snapshot_->scale(this->record_->scale);
+
+    return this->snapshot_->string(this->snapshot_->band(scale.first_band + this->record_->band).letter);
+}
+
+float hyx::Course_view::get_grade_points() const noexcept
+{
+    return this->record_->grade_points;
+}
+
+hyx::Course_status hyx::Course_view::get_status() const noexcept
+{
+    return static_cast<Course_status>(this->record_->status);
+}
+
+double hyx::Course_view::get_extra() const noexcept
+{
+    return this->record_->extra;
+}
+
+hyx::Schedule hyx::Course_view::get_schedule() const noexcept
+{
+    const snapshot::Course_record& record = *this->record_;
+
+    return { record.start_day, record.end_day, record.start_minute, record.end_minute, record.week_days };
+}
+
+hyx::Schedule hyx::Course_view::get_lab_schedule() const noexcept
+{
+    const snapshot::Course_record& record = *this->record_;
+
+    if (record.has_lab == 0)
+    {
+        return { Schedule::no_date, Schedule::no_date, Schedule::no_time, Schedule::no_time, 0 };
+    }
+
+    return { record.lab_start_day, record.lab_end_day, record.lab_start_minute, record.lab_end_minute, record.lab_week_days };
+}
+
+bool hyx::Course_view::is_point_based() const noexcept
+{
+    return this->record_->base_points != 0.0;
+}
+
+bool hyx::Course_view::is_included_in_gpa() const noexcept
+{
+    return this->record_->included_in_gpa != 0;
+}
+
+bool hyx::Course_view::has_lab() const noexcept
+{
+    return this->record_->has_lab != 0;
+}
+
+std::size_t hyx::Course_view::get_category_count() const noexcept
+{
+    return static_cast<std::size_t>(this->record_->category_count);
+}
+
+std::string_view hyx::Course_view::get_category_name(std::size_t index) const noexcept
+{
+    return this->snapshot_->string(this->category(index).name);
+}
+
+double hyx::Course_view::get_category_weight(std::size_t index) const noexcept
+{
+    return this->category(index).weight;
+}
+
+int hyx::Course_view::get_category_drops(std::size_t index) const noexcept
+{
+    return this->category(index).drops;
+}
+
+std::size_t hyx::Course_view::get_score_count(std::size_t index) const noexcept
+{
+    return static_cast<std::size_t>(this->category(index).score_count);
+}
+
+const double* hyx::Course_view::get_earned(std::size_t index) const noexcept
+{
+    return this->snapshot_->scores(this->category(index).first_score);
+}
+
+const double* hyx::Course_view::get_possible(std::size_t index) const noexcept
+{
+    const snapshot::Category_record& record = this->category(index);
+
+    return this->snapshot_->scores(record.first_score + record.score_count);
+}
+
+hyx::Course hyx::Course_view::to_course() const
+{
+    const snapshot::Course_record& record = *this->record_;
+
+    Course course(
+        std::string(this->get_name()),
+        this->get_crn(),
+        this->get_units(),
+        this->get_shared_scale(),
+        std::string(this->get_institution()),
+        std::string(this->get_location()),
+        std::string(this->get_instructor()),
+        std::string(this->get_details()),
+        schedule::unpack_week_days(record.week_days),
+        schedule::civil_from_days(record.start_day),
+        schedule::civil_from_days(record.end_day),
+        schedule::unpack_time(record.start_minute),
+        schedule::unpack_time(record.end_minute));
+
+    this->restore(course);
+
+    return course;
+}
+
+hyx::CourseWLAB hyx::Course_view::to_course_with_lab() const
+{
+    const snapshot::Course_record& record = *this->record_;
+
+    CourseWLAB course(
+        std::string(this->get_name()),
+        this->get_crn(),
+        this->get_units(),
+        this->get_shared_scale(),
+        std::string(this->get_institution()),
+        std::string(this->get_location()),
+        std::string(this->snapshot_->string(record.lab_location)),
+        std::string(this->get_instructor()),
+        std::string(this->get_details()),
+        schedule::unpack_week_days(record.week_days),
+        schedule::unpack_week_days(record.lab_week_days),
+        schedule::civil_from_days(record.start_day),
+        schedule::civil_from_days(record.end_day),
+        schedule::civil_from_days(record.lab_start_day),
+        schedule::civil_from_days(record.lab_end_day),
+        schedule::unpack_time(record.start_minute),
+        schedule::unpack_time(record.end_minute),
+        schedule::unpack_time(record.lab_start_minute),
+        schedule::unpack_time(record.lab_end_minute));
+
+    this->restore(course);
+
+    return course;
+}
+
+hyx::Snapshot::Snapshot() noexcept :
+    data_(nullptr),
+    size_(0)
+{
+}
+
+hyx::Snapshot::Snapshot(Snapshot&& other) noexcept :
+    data_(other.data_),
+    size_(other.size_)
+{
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+hyx::Snapshot& hyx::Snapshot::operator=(Snapshot&& other) noexcept
+{
+    if (this != &other)
+    {
+        this->close();
+
+        this->data_ = other.data_;
+        this->size_ = other.size_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+
+    return *this;
+}
+
+hyx::Snapshot::~Snapshot()
+{
+    this->close();
+}
+
+bool hyx::Snapshot::save(const std::string& path, const std::vector<const Course*>& courses)
+{
+    std::vector<snapshot::Scale_record> scales;
+    std::vector<snapshot::Band_record> bands;
+    std::vector<snapshot::Course_record> records;
+    std::vector<snapshot::Category_record> categories;
+    std::vector<snapshot::String_ref> books;
+    std::vector<double> scores;
+    Pool pool;
+
+    // courses share interned scales, so each one is written once.
+    std::unordered_map<const Compiled_scale*, std::uint32_t> scale_ids;
+
+    records.reserve(courses.size());
+
+    for (const Course* course : courses)
+    {
+        snapshot::Course_record record{};
+        const Compiled_scale* scale = &*course->scale_;
+
+        auto scale_itr = scale_ids.find(scale);
+
+        if (scale_itr == scale_ids.end())
+        {
+            scale_itr = scale_ids.emplace(scale, static_cast<std::uint32_t>(scales.size())).first;
+            scales.push_back({ bands.size(), scale->size() });
+
+            for (std::size_t i = 0; i < scale->size(); ++i)
+            {
+                const Compiled_scale::Band& band = scale->get_band(static_cast<std::uint8_t>(i));
+
+                bands.push_back({ pool.add(scale->get_letter(static_cast<std::uint8_t>(i))), band.low, band.high, scale->get_points(static_cast<std::uint8_t>(i)) });
+            }
+        }
+
+        record.name = pool.add(course->info_->name);
+        record.institution = pool.add(course->info_->institution);
+        record.location = pool.add(course->info_->location);
+        record.instructor = pool.add(course->info_->instructor);
+        record.details = pool.add(course->info_->details);
+        record.crn = course->crn_;
+        record.units = course->units_;
+        record.scale = scale_itr->second;
+        record.start_day = course->schedule_.start_day;
+        record.end_day = course->schedule_.end_day;
+        record.start_minute = course->schedule_.start_minute;
+        record.end_minute = course->schedule_.end_minute;
+        record.week_days = course->schedule_.week_days;
+        record.grade = course->grade_;
+        record.extra = course->extra_;
+        record.base_points = course->base_points_;
+        record.grade_points = course->grade_points_;
+        record.status = static_cast<std::uint8_t>(course->status_);
+        record.band = course->band_;
+        record.included_in_gpa = course->is_included_in_gpa();
+
+        if (const CourseWLAB* lab = dynamic_cast<const CourseWLAB*>(course))
+        {
+            record.has_lab = 1;
+            record.lab_location = pool.add(*lab->lab_location_);
+            record.lab_start_day = lab->lab_schedule_.start_day;
+            record.lab_end_day = lab->lab_schedule_.end_day;
+            record.lab_start_minute = lab->lab_schedule_.start_minute;
+            record.lab_end_minute = lab->lab_schedule_.end_minute;
+            record.lab_week_days = lab->lab_schedule_.week_days;
+        }
+
+        record.first_category = categories.size();
+        record.category_count = course->points_.size();
+
+        for (std::uint32_t id = 0; id < course->points_.size(); ++id)
+        {
+            const Course::Category& category = *course->points_[id];
+            const double* earned = course->scores_.earned(id);
+            const double* possible = course->scores_.possible(id);
+            std::size_t count = course->scores_.size(id);
+
+            categories.push_back({ pool.add(category.name), pool.add(category.replace.second), category.weight, category.drops, category.replace.first, scores.size(), count });
+
+            scores.insert(scores.end(), earned, earned + count);
+            scores.insert(scores.end(), possible, possible + count);
+        }
+
+        record.first_book = books.size();
+        record.book_count = course->info_->books.size();
+
+        for (const auto& book : course->info_->books)
+        {
+            books.push_back(pool.add(book));
+        }
+
+        records.push_back(record);
+    }
+
+    snapshot::File_header header{};
+    std::uint64_t offset = sizeof(snapshot::File_header);
+
+    std::memcpy(header.magic, snapshot::magic, sizeof(header.magic));
+    header.version = snapshot::version;
+    header.byte_order = snapshot::byte_order;
+    header.course_count = records.size();
+    header.scale_count = scales.size();
+    header.band_count = bands.size();
+    header.category_count = categories.size();
+    header.book_count = books.size();
+    header.score_count = scores.size();
+    header.pool_size = pool.data.size();
+    header.scales = place(offset, scales.size(), sizeof(snapshot::Scale_record));
+    header.bands = place(offset, bands.size(), sizeof(snapshot::Band_record));
+    header.courses = place(offset, records.size(), sizeof(snapshot::Course_record));
+    header.categories = place(offset, categories.size(), sizeof(snapshot::Category_record));
+    header.books = place(offset, books.size(), sizeof(snapshot::String_ref));
+    header.scores = place(offset, scores.size(), sizeof(double));
+    header.pool = place(offset, pool.data.size(), 1);
+
+    // written beside the target and renamed over it once it is on disk, so a failed save leaves the old file whole
+    // and a snapshot already open on the old file keeps its mapping. the name is unique, so saves to one path never share it.
+    std::string temp_path = path + ".XXXXXX";
+    int fd = ::mkstemp(&temp_path[0]);
+
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    // mkstemp only lets the owner read it.
+    bool good = ::fchmod(fd, 0644) == 0;
+
+    good = good && write_all(fd, &header, sizeof(header))
+        && write_all(fd, scales.data(), scales.size() * sizeof(snapshot::Scale_record))
+        && write_all(fd, bands.data(), bands.size() * sizeof(snapshot::Band_record))
+        && write_all(fd, records.data(), records.size() * sizeof(snapshot::Course_record))
+        && write_all(fd, categories.data(), categories.size() * sizeof(snapshot::Category_record))
+        && write_all(fd, books.data(), books.size() * sizeof(snapshot::String_ref))
+        && write_all(fd, scores.data(), scores.size() * sizeof(double))
+        && write_all(fd, pool.data.data(), pool.data.size())
+        && ::fsync(fd) == 0;
+
+    good = (::close(fd) == 0) && good && ::rename(temp_path.c_str(), path.c_str()) == 0;
+
+    if (not good)
+    {
+        ::unlink(temp_path.c_str());
+
+        return false;
+    }
+
+    return sync_directory(path);
+}
+
+bool hyx::Snapshot::open(const std::string& path) noexcept
+{
+    this->close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+
+    if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(snapshot::File_header))
+    {
+        ::close(fd);
+
+        return false;
+    }
+
+    void* data = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // the mapping stays valid after the descriptor is closed.
+    ::close(fd);
+
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    this->data_ = static_cast<const unsigned char*>(data);
+    this->size_ = static_cast<std::size_t>(info.st_size);
+
+    if (not this->validate())
+    {
+        this->close();
+
+        return false;
+    }
+
+    return true;
+}
+
+bool hyx::Snapshot::validate() const noexcept
+{
+    const snapshot::File_header& header = this->header();
+
+    if (std::memcmp(header.magic, snapshot::magic, sizeof(header.magic)) != 0
+        || header.version != snapshot::version
+        || header.byte_order != snapshot::byte_order)
+    {
+        return false;
+    }
+
+    if (not fits(this->size_, header.scales, header.scale_count, sizeof(snapshot::Scale_record), alignof(snapshot::Scale_record))
+        || not fits(this->size_, header.bands, header.band_count, sizeof(snapshot::Band_record), alignof(snapshot::Band_record))
+        || not fits(this->size_, header.courses, header.course_count, sizeof(snapshot::Course_record), alignof(snapshot::Course_record))
+        || not fits(this->size_, header.categories, header.category_count, sizeof(snapshot::Category_record), alignof(snapshot::Category_record))
+        || not fits(this->size_, header.books, header.book_count, sizeof(snapshot::String_ref), alignof(snapshot::String_ref))
+        || not fits(this->size_, header.scores, header.score_count, sizeof(double), alignof(double))
+        || not fits(this->size_, header.pool, header.pool_size, 1, 1))
+    {
+        return false;
+    }
+
+    auto good_string = [&](const snapshot::String_ref& ref) { return within(ref.offset, ref.size, header.pool_size); };
+
+    // only the tables are checked here; scores are never read until they are asked for.
+    for (std::uint64_t i = 0; i < header.scale_count; ++i)
+    {
+        if (this->scale(i).band_count > Compiled_scale::max_bands || not within(this->scale(i).first_band, this->scale(i).band_count, header.band_count))
+        {
+            return false;
+        }
+    }
+
+    for (std::uint64_t i = 0; i < header.band_count; ++i)
+    {
+        if (not good_string(this->band(i).letter))
+        {
+            return false;
+        }
+    }
+
+    for (std::uint64_t i = 0; i < header.category_count; ++i)
+    {
+        const snapshot::Category_record& category = this->category(i);
+
+        if (not good_string(category.name) || not good_string(category.replace_name)
+            || category.score_count > header.score_count / 2
+            || not within(category.first_score, category.score_count * 2, header.score_count))
+        {
+            return false;
+        }
+    }
+
+    for (std::uint64_t i = 0; i < header.book_count; ++i)
+    {
+        if (not good_string(this->book(i)))
+        {
+            return false;
+        }
+    }
+
+    for (std::uint64_t i = 0; i < header.course_count; ++i)
+    {
+        const snapshot::Course_record& course = reinterpret_cast<const snapshot::Course_record*>(this->data_ + header.courses)[i];
+
+        if (not good_string(course.name) || not good_string(course.institution) || not good_string(course.location)
+            || not good_string(course.instructor) || not good_string(course.details) || not good_string(course.lab_location)
+            || course.scale >= header.scale_count
+            || (course.band != Compiled_scale::npos && course.band >= this->scale(course.scale).band_count)
+            || course.status > static_cast<std::uint8_t>(Course_status::incomplete)
+            || not within(course.first_category, course.category_count, header.category_count)
+            || not within(course.first_book, course.book_count, header.book_count))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void hyx::Snapshot::close() noexcept
+{
+    if (this->data_ != nullptr)
+    {
+        ::munmap(const_cast<unsigned char*>(this->data_), this->size_);
+    }
+
+    this->data_ = nullptr;
+    this->size_ = 0;
+}
+
+bool hyx::Snapshot::is_open() const noexcept
+{
+    return this->data_ != nullptr;
+}
+
+std::size_t hyx::Snapshot::size() const noexcept
+{
+    return (this->is_open()) ? static_cast<std::size_t>(this->header().course_count) : 0;
+}
+
+hyx::Course_view hyx::Snapshot::operator[](std::size_t index) const noexcept
+{
+    return Course_view(this, reinterpret_cast<const snapshot::Course_record*>(this->data_ + this->header().courses) + index);
+}
+
+const hyx::snapshot::File_header& hyx::Snapshot::header() const noexcept
+{
+    return *reinterpret_cast<const snapshot::File_header*>(this->data_);
+}
+
+std::string_view hyx::Snapshot::string(const snapshot::String_ref& ref) const noexcept
+{
+    return std::string_view(reinterpret_cast<const char*>(this->data_ + this->header().pool + ref.offset), static_cast<std::size_t>(ref.size));
+}
+
+const hyx::snapshot::Scale_record& hyx::Snapshot::scale(std::size_t index) const noexcept
+{
+    return reinterpret_cast<const snapshot::Scale_record*>(this->data_ + this->header().scales)[index];
+}
+
+const hyx::snapshot::Band_record& hyx::Snapshot::band(std::size_t index) const noexcept
+{
+    return reinterpret_cast<const snapshot::Band_record*>(this->data_ + this->header().bands)[index];
+}
+
+const hyx::snapshot::Category_record& hyx::Snapshot::category(std::size_t index) const noexcept
+{
+    return reinterpret_cast<const snapshot::Category_record*>(this->data_ + this->header().categories)[index];
+}
+
+const hyx::snapshot::String_ref& hyx::Snapshot::book(std::size_t index) const noexcept
+{
+    return reinterpret_cast<const snapshot::String_ref*>(this->data_ + this->header().books)[index];
+}
+
+const double* hyx::Snapshot::scores(std::size_t index) const noexcept
+{
+    return reinterpret_cast<const double*>(this->data_ + this->header().scores) + index;
+}
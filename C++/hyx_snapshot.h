@@ -0,0 +1,273 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#ifndef HYX_SNAPSHOT_H
+#define HYX_SNAPSHOT_H
+
+#include <cstddef> // size_t
+#include <cstdint> // uint8_t, uint32_t, uint64_t, int32_t, int64_t
+#include <string> // string
+#include <string_view> // string_view
+#include <type_traits> // is_trivially_copyable_v
+#include <vector> // vector
+
+#include "hyx_course.h"
+
+
+// the on-disk layout; every section is an array of one of these records, 8 byte aligned, in native byte order.
+namespace hyx::snapshot
+{
+    inline constexpr char magic[8] = { 'H', 'Y', 'X', 'S', 'N', 'A', 'P', '\0' };
+
+    inline constexpr std::uint32_t version = 2;
+
+    // written as is; a file from a machine with the other byte order reads back swapped.
+    inline constexpr std::uint32_t byte_order = 0x01020304;
+
+    // offset into the string pool, length
+    struct String_ref
+    {
+        std::uint64_t offset;
+        std::uint64_t size;
+    };
+
+    struct File_header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byte_order;
+
+        // counts of records in each section; scores counts doubles.
+        std::uint64_t course_count;
+        std::uint64_t scale_count;
+        std::uint64_t band_count;
+        std::uint64_t category_count;
+        std::uint64_t book_count;
+        std::uint64_t score_count;
+        std::uint64_t pool_size;
+
+        // file offsets of each section.
+        std::uint64_t scales;
+        std::uint64_t bands;
+        std::uint64_t courses;
+        std::uint64_t categories;
+        std::uint64_t books;
+        std::uint64_t scores;
+        std::uint64_t pool;
+    };
+
+    // bands from the highest one down, as in Compiled_scale.
+    struct Scale_record
+    {
+        std::uint64_t first_band;
+        std::uint64_t band_count;
+    };
+
+    // points is -1 for letters that carry none.
+    struct Band_record
+    {
+        String_ref letter;
+        std::int32_t low;
+        std::int32_t high;
+        double points;
+    };
+
+    // the scores of a category are score_count earned values followed by score_count possible values.
+    struct Category_record
+    {
+        String_ref name;
+        String_ref replace_name;
+        double weight;
+        std::int32_t drops;
+        std::int32_t replace_count;
+        std::uint64_t first_score;
+        std::uint64_t score_count;
+    };
+
+    // lab fields are zero unless has_lab is set. the schedule is packed as in Schedule.
+    struct Course_record
+    {
+        String_ref name;
+        String_ref institution;
+        String_ref location;
+        String_ref instructor;
+        String_ref details;
+        String_ref lab_location;
+        std::int64_t crn;
+        std::int32_t units;
+        std::uint32_t scale;
+        std::int32_t start_day;
+        std::int32_t end_day;
+        std::int32_t lab_start_day;
+        std::int32_t lab_end_day;
+        std::uint16_t start_minute;
+        std::uint16_t end_minute;
+        std::uint16_t lab_start_minute;
+        std::uint16_t lab_end_minute;
+        std::uint8_t week_days;
+        std::uint8_t lab_week_days;
+
+        // zero; keeps the record free of padding.
+        std::uint8_t reserved[6];
+        double grade;
+        double extra;
+        double base_points;
+        float grade_points;
+        std::uint8_t status;
+        std::uint8_t band;
+        std::uint8_t has_lab;
+        std::uint8_t included_in_gpa;
+        std::uint64_t first_category;
+        std::uint64_t category_count;
+        std::uint64_t first_book;
+        std::uint64_t book_count;
+    };
+
+    static_assert(std::is_trivially_copyable_v<File_header> && sizeof(File_header) % 8 == 0);
+    static_assert(std::is_trivially_copyable_v<Band_record> && sizeof(Band_record) % 8 == 0);
+    static_assert(std::is_trivially_copyable_v<Category_record> && sizeof(Category_record) % 8 == 0);
+    static_assert(std::is_trivially_copyable_v<Course_record> && sizeof(Course_record) % 8 == 0);
+
+} // hyx::snapshot
+
+namespace hyx
+{
+    class Snapshot;
+
+    // a read-only course inside a mapped snapshot; strings and scores point straight into the file,
+    // so a view is only good while its snapshot stays open and in place.
+    class Course_view
+    {
+    private:
+
+        const Snapshot* snapshot_;
+        const snapshot::Course_record* record_;
+
+        [[nodiscard]] const snapshot::Category_record& category(std::size_t index) const noexcept;
+
+        [[nodiscard]] Shared_scale get_shared_scale() const;
+
+        void restore(Course& course) const;
+
+    public:
+
+        Course_view(const Snapshot* snapshot, const snapshot::Course_record* record) noexcept;
+
+        [[nodiscard]] std::string_view get_name() const noexcept;
+
+        [[nodiscard]] long get_crn() const noexcept;
+
+        [[nodiscard]] int get_units() const noexcept;
+
+        [[nodiscard]] std::string_view get_institution() const noexcept;
+
+        [[nodiscard]] std::string_view get_location() const noexcept;
+
+        [[nodiscard]] std::string_view get_instructor() const noexcept;
+
+        [[nodiscard]] std::string_view get_details() const noexcept;
+
+        [[nodiscard]] double get_grade() const noexcept;
+
+        [[nodiscard]] std::string_view get_letter() const noexcept;
+
+        [[nodiscard]] float get_grade_points() const noexcept;
+
+        [[nodiscard]] Course_status get_status() const noexcept;
+
+        [[nodiscard]] double get_extra() const noexcept;
+
+        [[nodiscard]] Schedule get_schedule() const noexcept;
+
+        // a schedule with no days, dates or times when the course has no lab.
+        [[nodiscard]] Schedule get_lab_schedule() const noexcept;
+
+        [[nodiscard]] bool is_point_based() const noexcept;
+
+        [[nodiscard]] bool is_included_in_gpa() const noexcept;
+
+        [[nodiscard]] bool has_lab() const noexcept;
+
+        [[nodiscard]] std::size_t get_category_count() const noexcept;
+
+        [[nodiscard]] std::string_view get_category_name(std::size_t index) const noexcept;
+
+        [[nodiscard]] double get_category_weight(std::size_t index) const noexcept;
+
+        [[nodiscard]] int get_category_drops(std::size_t index) const noexcept;
+
+        [[nodiscard]] std::size_t get_score_count(std::size_t index) const noexcept;
+
+        [[nodiscard]] const double* get_earned(std::size_t index) const noexcept;
+
+        [[nodiscard]] const double* get_possible(std::size_t index) const noexcept;
+
+        // a full, editable copy; lab fields are dropped.
+        [[nodiscard]] Course to_course() const;
+
+        // only meaningful when has_lab().
+        [[nodiscard]] CourseWLAB to_course_with_lab() const;
+
+    };
+
+    // a memory mapped snapshot file; courses are only read when they are looked at.
+    class Snapshot
+    {
+    private:
+
+        const unsigned char* data_;
+        std::size_t size_;
+
+        [[nodiscard]] bool validate() const noexcept;
+
+    public:
+
+        Snapshot() noexcept;
+
+        Snapshot(const Snapshot& other) = delete;
+
+        Snapshot(Snapshot&& other) noexcept;
+
+        Snapshot& operator=(const Snapshot& other) = delete;
+
+        Snapshot& operator=(Snapshot&& other) noexcept;
+
+        ~Snapshot();
+
+        // writes the courses to a unique file beside path and renames it over path once the whole file is on disk; false if it
+        // could not be, with path left as it was, or if the directory could not be flushed after the rename.
+        static bool save(const std::string& path, const std::vector<const Course*>& courses);
+
+        // false if the file is missing, truncated, of another version or inconsistent.
+        bool open(const std::string& path) noexcept;
+
+        void close() noexcept;
+
+        [[nodiscard]] bool is_open() const noexcept;
+
+        [[nodiscard]] std::size_t size() const noexcept;
+
+        [[nodiscard]] Course_view operator[](std::size_t index) const noexcept;
+
+        [[nodiscard]] const snapshot::File_header& header() const noexcept;
+
+        [[nodiscard]] std::string_view string(const snapshot::String_ref& ref) const noexcept;
+
+        [[nodiscard]] const snapshot::Scale_record& scale(std::size_t index) const noexcept;
+
+        [[nodiscard]] const snapshot::Band_record& band(std::size_t index) const noexcept;
+
+        [[nodiscard]] const snapshot::Category_record& category(std::size_t index) const noexcept;
+
+        [[nodiscard]] const snapshot::String_ref& book(std::size_t index) const noexcept;
+
+        [[nodiscard]] const double* scores(std::size_t index) const noexcept;
+
+    };
+
+} // hyx
+
+#endif // !HYX_SNAPSHOT_H
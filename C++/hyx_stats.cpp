@@ -0,0 +1,212 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#include "hyx_stats.h"
+#include "hyx_json.h"
+
+#include <chrono> //steady_clock, duration
+#include <iomanip> //setw
+#include <mutex> //mutex, lock_guard
+
+namespace
+{
+    // what flushed threads left behind, and how many threads ever counted anything.
+    struct Registry
+    {
+        std::mutex lock;
+        hyx::stats::Thread_counters flushed{};
+        std::size_t threads = 0;
+    };
+
+    Registry& registry()
+    {
+        static Registry registry;
+
+        return registry;
+    }
+
+    // flushes its thread's counts when the thread exits.
+    struct Flusher
+    {
+        ~Flusher()
+        {
+            hyx::stats::flush();
+        }
+    };
+
+#ifdef HYX_STATS_TSC
+    // the counter and the clock read together at start up; how far both have moved since gives the length of a tick.
+    const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+    const std::uint64_t start_ticks = __rdtsc();
+#endif
+
+    double nanoseconds_per_tick()
+    {
+#ifdef HYX_STATS_TSC
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+        // a few milliseconds are needed for a usable ratio.
+        while (now - start_time < std::chrono::milliseconds(10))
+        {
+            now = std::chrono::steady_clock::now();
+        }
+
+        std::uint64_t now_ticks = __rdtsc();
+
+        return std::chrono::duration<double, std::nano>(now - start_time).count() / static_cast<double>(now_ticks - start_ticks);
+#else
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::duration(1)).count();
+#endif
+    }
+
+    void add_counts(hyx::stats::Thread_counters& to, const hyx::stats::Thread_counters& from) noexcept
+    {
+        for (std::size_t i = 0; i < hyx::stats::counter_count; ++i)
+        {
+            to.events[i] += from.events[i];
+            to.ticks[i] += from.ticks[i];
+            to.samples[i] += from.samples[i];
+        }
+    }
+
+    void clear_counts(hyx::stats::Thread_counters& counts) noexcept
+    {
+        counts.events.fill(0);
+        counts.ticks.fill(0);
+        counts.samples.fill(0);
+    }
+
+    // sampled ticks are scaled up by how many events there were for each one timed.
+    hyx::stats::Totals to_totals(const hyx::stats::Thread_counters& counts, std::size_t threads)
+    {
+        hyx::stats::Totals totals{ counts.events, {}, threads };
+        double tick = (hyx::stats::enabled()) ? nanoseconds_per_tick() : 0.0;
+
+        for (std::size_t i = 0; i < hyx::stats::counter_count; ++i)
+        {
+            totals.nanoseconds[i] = (counts.samples[i] != 0)
+                ? static_cast<double>(counts.ticks[i]) * tick * static_cast<double>(counts.events[i]) / static_cast<double>(counts.samples[i]) : 0.0;
+        }
+
+        return totals;
+    }
+}
+
+void hyx::stats::enroll()
+{
+    static thread_local Flusher flusher;
+
+    static_cast<void>(flusher);
+    counters.enrolled = true;
+
+    Registry& shared = registry();
+    std::lock_guard<std::mutex> guard(shared.lock);
+
+    ++shared.threads;
+}
+
+const char* hyx::stats::name(Counter counter) noexcept
+{
+    static constexpr const char* names[counter_count] = {
+        "update_grade",
+        "update_letter",
+        "update_grade_points",
+        "get_points",
+        "drops",
+        "replacements",
+        "points_entries"
+    };
+
+    return names[static_cast<std::size_t>(counter)];
+}
+
+void hyx::stats::flush()
+{
+    Registry& shared = registry();
+    std::lock_guard<std::mutex> guard(shared.lock);
+
+    add_counts(shared.flushed, counters);
+    clear_counts(counters);
+}
+
+hyx::stats::Totals hyx::stats::collect()
+{
+    Registry& shared = registry();
+    Thread_counters counts{};
+    std::size_t threads = 0;
+
+    {
+        std::lock_guard<std::mutex> guard(shared.lock);
+
+        counts = shared.flushed;
+        threads = shared.threads;
+    }
+
+    add_counts(counts, counters);
+
+    return to_totals(counts, threads);
+}
+
+hyx::stats::Totals hyx::stats::this_thread()
+{
+    return to_totals(counters, 1);
+}
+
+void hyx::stats::reset()
+{
+    Registry& shared = registry();
+    std::lock_guard<std::mutex> guard(shared.lock);
+
+    clear_counts(shared.flushed);
+    clear_counts(counters);
+}
+
+std::ostream& hyx::stats::operator<<(std::ostream& out, const Totals& totals)
+{
+    out << std::left << std::setw(22) << "counter" << std::right << std::setw(14) << "events" << std::setw(16) << "total ns" << std::setw(12) << "ns/event" << '\n';
+
+    for (std::size_t i = 0; i < counter_count; ++i)
+    {
+        out << std::left << std::setw(22) << name(static_cast<Counter>(i)) << std::right << std::setw(14) << totals.events[i];
+
+        // drops, replacements and entries are only counted, never timed.
+        if (totals.nanoseconds[i] != 0)
+        {
+            out << std::setw(16) << static_cast<std::uint64_t>(totals.nanoseconds[i])
+                << std::setw(12) << std::fixed << std::setprecision(1) << totals.nanoseconds[i] / totals.events[i] << std::defaultfloat;
+        }
+
+        out << '\n';
+    }
+
+    return out << totals.threads << ((totals.threads == 1) ? " thread" : " threads") << ((enabled()) ? "" : ", built without HYX_STATS") << '\n';
+}
+
+void hyx::stats::append_json(std::string& out, const Totals& totals)
+{
+    out += "{\"enabled\":";
+    out += (enabled()) ? "true" : "false";
+    out += ",\"threads\":";
+    json::append_number(out, static_cast<double>(totals.threads));
+    out += ",\"counters\":{";
+
+    for (std::size_t i = 0; i < counter_count; ++i)
+    {
+        if (i != 0)
+        {
+            out += ',';
+        }
+
+        json::append_string(out, name(static_cast<Counter>(i)));
+        out += ":{\"events\":";
+        json::append_number(out, static_cast<double>(totals.events[i]));
+        out += ",\"nanoseconds\":";
+        json::append_number(out, totals.nanoseconds[i]);
+        out += '}';
+    }
+
+    out += "}}";
+}
@@ -0,0 +1,176 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#ifndef HYX_STATS_H
+#define HYX_STATS_H
+
+#include <array> // array
+#include <cstddef> // size_t
+#include <cstdint> // uint8_t, uint64_t
+#include <ostream> // ostream
+#include <string> // string
+
+#if defined(HYX_STATS) && (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define HYX_STATS_TSC 1
+#include <x86intrin.h> // __rdtsc
+#else
+#include <chrono> // steady_clock
+#endif
+
+// the library counts its hot paths only when built with -DHYX_STATS; otherwise the macros compile to nothing, events unevaluated, and every total reads zero.
+#ifdef HYX_STATS
+#define HYX_STATS_COUNT(counter, events) ::hyx::stats::add(::hyx::stats::Counter::counter, events)
+#define HYX_STATS_TIME(counter) const ::hyx::stats::Timer hyx_stats_timer_(::hyx::stats::Counter::counter)
+#else
+#define HYX_STATS_COUNT(counter, events) static_cast<void>(sizeof(events))
+#define HYX_STATS_TIME(counter) static_cast<void>(0)
+#endif
+
+
+namespace hyx::stats
+{
+    enum class Counter : std::uint8_t
+    {
+        update_grade,
+        update_letter,
+        update_grade_points,
+        get_points,
+
+        // grades left out of, and grades replaced in, a category's stored totals each time they are rebuilt; a grade that simply counts rebuilds nothing,
+        // and what_if, required_score and projections, which never store a grade, are not counted.
+        drops,
+        replacements,
+
+        // entries get_points builds, each one at least a map node and a string.
+        points_entries
+    };
+
+    constexpr std::size_t counter_count = static_cast<std::size_t>(Counter::points_entries) + 1;
+
+    [[nodiscard]] const char* name(Counter counter) noexcept;
+
+    [[nodiscard]] constexpr bool enabled() noexcept
+    {
+#ifdef HYX_STATS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // one thread's counts since it last flushed: plain integers, since only that thread ever reads or writes them.
+    struct Thread_counters
+    {
+        std::array<std::uint64_t, counter_count> events;
+        std::array<std::uint64_t, counter_count> ticks;
+
+        // timed events, one in every sample_period.
+        std::array<std::uint64_t, counter_count> samples;
+        bool enrolled;
+    };
+
+    // how often a timed event reads the clock; the total is scaled up from the ones that did.
+    constexpr std::uint64_t sample_period = 64;
+
+    // constant initialised and trivially destroyed, so reaching it costs no guard.
+    inline thread_local Thread_counters counters{};
+
+    // the first count on a thread lands here once, so its counts are flushed when the thread exits.
+    void enroll();
+
+    inline void add(Counter counter, std::uint64_t events) noexcept
+    {
+        if (not counters.enrolled)
+        {
+            enroll();
+        }
+
+        counters.events[static_cast<std::size_t>(counter)] += events;
+    }
+
+    // the time stamp counter where there is one, so a timed event costs two reads of it and no call.
+    inline std::uint64_t ticks() noexcept
+    {
+#ifdef HYX_STATS_TSC
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    // counts one event and, for one in every sample_period, the ticks from construction to destruction; times include anything the scope calls.
+    class Timer
+    {
+    private:
+
+        std::size_t index_;
+        bool sampled_;
+        std::uint64_t start_;
+
+    public:
+
+        explicit Timer(Counter counter) noexcept
+            : index_(static_cast<std::size_t>(counter)),
+            sampled_(false),
+            start_(0)
+        {
+            if (not counters.enrolled)
+            {
+                enroll();
+            }
+
+            this->sampled_ = counters.events[this->index_]++ % sample_period == 0;
+
+            if (this->sampled_)
+            {
+                this->start_ = ticks();
+            }
+        }
+
+        ~Timer()
+        {
+            if (this->sampled_)
+            {
+                counters.ticks[this->index_] += ticks() - this->start_;
+                ++counters.samples[this->index_];
+            }
+        }
+
+        Timer(const Timer&) = delete;
+
+        Timer& operator=(const Timer&) = delete;
+    };
+
+    struct Totals
+    {
+        std::array<std::uint64_t, counter_count> events;
+        std::array<double, counter_count> nanoseconds;
+
+        // threads that have counted anything, finished ones included.
+        std::size_t threads;
+    };
+
+    // adds the calling thread's counts to the shared totals and zeroes them; threads do this themselves when they exit.
+    void flush();
+
+    // the shared totals plus the calling thread's counts. another thread that is still running is left out until it flushes or exits.
+    [[nodiscard]] Totals collect();
+
+    // only the calling thread's counts since it last flushed.
+    [[nodiscard]] Totals this_thread();
+
+    // zeroes the shared totals and the calling thread's counts.
+    void reset();
+
+    // a table with one row per counter: events, total nanoseconds and nanoseconds per event.
+    std::ostream& operator<<(std::ostream& out, const Totals& totals);
+
+    // {"enabled": true, "threads": 2, "counters": {"update_grade": {"events": 10, "nanoseconds": 520}, ...}}
+    void append_json(std::string& out, const Totals& totals);
+
+} // hyx::stats
+
+#endif // !HYX_STATS_H
@@ -0,0 +1,211 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#include "hyx_transcript.h"
+#include "hyx_parallel.h"
+
+#include <algorithm> //max
+#include <atomic> //atomic
+#include <cerrno> //errno, EINTR
+#include <charconv> //to_chars, chars_format
+#include <condition_variable> //condition_variable
+#include <mutex> //mutex, unique_lock
+#include <unistd.h> //write
+
+void hyx::render_transcript(std::string& out, const Transcript& transcript)
+{
+    out.append("Student: ").append(transcript.student).append("\n\n");
+
+    for (const Course* course : transcript.courses)
+    {
+        course->render(out);
+        out.push_back('\n');
+    }
+
+    GPA_accumulator term = hyx::accumulate_GPA(transcript.courses);
+
+    out.append("Term GPA: ");
+
+    if (term.get_units() == 0)
+    {
+        out.append("N/A");
+    }
+    else
+    {
+        char buff[32];
+
+        out.append(buff, std::to_chars(buff, buff + sizeof(buff), term.get_GPA(), std::chars_format::fixed, 3).ptr);
+    }
+
+    out.append("\n\n");
+}
+
+hyx::Transcript_writer::Transcript_writer(int fd, std::size_t buffer_size, unsigned int threads) :
+    fd_(fd),
+    buffer_size_(std::max<std::size_t>(buffer_size, 1)),
+    threads_((threads == 0) ? hyx::default_threads() : threads),
+    buffer_(),
+    good_(true)
+{
+    this->buffer_.reserve(this->buffer_size_);
+}
+
+hyx::Transcript_writer::~Transcript_writer()
+{
+    this->flush();
+}
+
+bool hyx::Transcript_writer::write_out(const char* data, std::size_t size) noexcept
+{
+    while (this->good_ && size > 0)
+    {
+        ssize_t written = ::write(this->fd_, data, size);
+
+        if (written < 0)
+        {
+            this->good_ = (errno == EINTR);
+        }
+        else
+        {
+            data += written;
+            size -= static_cast<std::size_t>(written);
+        }
+    }
+
+    return this->good_;
+}
+
+bool hyx::Transcript_writer::append(const std::string& page) noexcept
+{
+    if (this->buffer_.size() + page.size() > this->buffer_size_ && not this->flush())
+    {
+        return false;
+    }
+
+    // pages bigger than the whole buffer skip it.
+    if (page.size() >= this->buffer_size_)
+    {
+        return this->write_out(page.data(), page.size());
+    }
+
+    this->buffer_.append(page);
+
+    return true;
+}
+
+bool hyx::Transcript_writer::write(const Transcript& transcript)
+{
+    if (not this->good_)
+    {
+        return false;
+    }
+
+    std::size_t size = this->buffer_.size();
+
+    try
+    {
+        hyx::render_transcript(this->buffer_, transcript);
+    }
+    catch (...)
+    {
+        // drop the half rendered page.
+        this->buffer_.resize(size);
+        this->good_ = false;
+
+        return false;
+    }
+
+    return (this->buffer_.size() >= this->buffer_size_) ? this->flush() : true;
+}
+
+bool hyx::Transcript_writer::write(const std::vector<Transcript>& transcripts)
+{
+    if (not this->good_)
+    {
+        return false;
+    }
+
+    if (this->threads_ == 1)
+    {
+        for (const auto& transcript : transcripts)
+        {
+            if (not this->write(transcript))
+            {
+                return false;
+            }
+        }
+
+        return this->good_;
+    }
+
+    // one pool renders every student, and each page waits for the one before it,
+    // so besides the buffer at most one page per thread is ever held in memory.
+    std::mutex lock;
+    std::condition_variable turn;
+    std::size_t next = 0;
+    std::atomic<bool> failed(false);
+
+    try
+    {
+        hyx::parallel_for(transcripts.size(), this->threads_, [&](std::size_t first, std::size_t last) {
+            thread_local std::string page;
+
+            for (std::size_t i = first; i < last; ++i)
+            {
+                page.clear();
+
+                if (not failed)
+                {
+                    try
+                    {
+                        hyx::render_transcript(page, transcripts[i]);
+                    }
+                    catch (...)
+                    {
+                        failed = true;
+                    }
+                }
+
+                std::unique_lock<std::mutex> guard(lock);
+
+                turn.wait(guard, [&]() { return next == i; });
+
+                if (not failed && not this->append(page))
+                {
+                    failed = true;
+                }
+
+                ++next;
+                turn.notify_all();
+            }
+            });
+    }
+    catch (...)
+    {
+        failed = true;
+    }
+
+    if (failed)
+    {
+        this->good_ = false;
+    }
+
+    return this->good_;
+}
+
+bool hyx::Transcript_writer::flush() noexcept
+{
+    bool good = this->write_out(this->buffer_.data(), this->buffer_.size());
+
+    this->buffer_.clear();
+
+    return good;
+}
+
+bool hyx::Transcript_writer::good() const noexcept
+{
+    return this->good_;
+}
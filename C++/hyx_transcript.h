@@ -0,0 +1,70 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#ifndef HYX_TRANSCRIPT_H
+#define HYX_TRANSCRIPT_H
+
+#include <cstddef> // size_t
+#include <string> // string
+#include <vector> // vector
+
+#include "hyx_course.h"
+
+
+namespace hyx
+{
+    // one student's courses for a term, in the order they are printed.
+    struct Transcript
+    {
+        std::string student;
+        std::vector<const Course*> courses;
+    };
+
+    // appends the student, every course report and the term GPA.
+    void render_transcript(std::string& out, const Transcript& transcript);
+
+    // streams transcripts to a file descriptor through a buffer of buffer_size bytes.
+    // with more than one thread, students are formatted in parallel and written in order.
+    // a page that cannot be allocated or a thread that cannot be started fails the writer like a failed write.
+    class Transcript_writer
+    {
+    private:
+
+        int fd_;
+        std::size_t buffer_size_;
+        unsigned int threads_;
+        std::string buffer_;
+        bool good_;
+
+        bool write_out(const char* data, std::size_t size) noexcept;
+
+        bool append(const std::string& page) noexcept;
+
+    public:
+
+        Transcript_writer(int fd, std::size_t buffer_size = 1 << 20, unsigned int threads = 1);
+
+        Transcript_writer(const Transcript_writer& other) = delete;
+
+        Transcript_writer& operator=(const Transcript_writer& other) = delete;
+
+        // flushes whatever is still buffered.
+        ~Transcript_writer();
+
+        bool write(const Transcript& transcript);
+
+        bool write(const std::vector<Transcript>& transcripts);
+
+        bool flush() noexcept;
+
+        // false once any write to the file descriptor has failed.
+        [[nodiscard]] bool good() const noexcept;
+
+    };
+
+} // hyx
+
+#endif // !HYX_TRANSCRIPT_H
@@ -0,0 +1,337 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#include "hyx_utilization.h"
+
+#include <algorithm> //max, min
+
+namespace
+{
+    // bits past the last slot of the week, which must stay clear.
+    constexpr std::uint64_t last_word_mask = (7 * hyx::Week_slots::day_slots % 64 == 0)
+        ? ~std::uint64_t{ 0 } : (std::uint64_t{ 1 } << (7 * hyx::Week_slots::day_slots % 64)) - 1;
+
+    std::size_t popcount(std::uint64_t word) noexcept
+    {
+#if defined(__GNUC__)
+        return static_cast<std::size_t>(__builtin_popcountll(word));
+#else
+        word = word - ((word >> 1) & 0x5555555555555555ull);
+        word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+        word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+
+        return static_cast<std::size_t>((word * 0x0101010101010101ull) >> 56);
+#endif
+    }
+
+    // word must not be zero.
+    std::size_t lowest_bit(std::uint64_t word) noexcept
+    {
+#if defined(__GNUC__)
+        return static_cast<std::size_t>(__builtin_ctzll(word));
+#else
+        return popcount((word & (0 - word)) - 1);
+#endif
+    }
+
+    // the first slot in [from, to) whose bit equals value, or to; whole words that cannot hold one are skipped.
+    std::size_t next_slot(const hyx::Week_slots& slots, std::size_t from, std::size_t to, bool value) noexcept
+    {
+        while (from < to)
+        {
+            std::uint64_t word = (value) ? slots.words[from / 64] : ~slots.words[from / 64];
+
+            word &= ~std::uint64_t{ 0 } << (from % 64);
+
+            if (word != 0)
+            {
+                return std::min(to, from / 64 * 64 + lowest_bit(word));
+            }
+
+            from = (from / 64 + 1) * 64;
+        }
+
+        return to;
+    }
+}
+
+hyx::Week_slots hyx::Week_slots::hours(std::uint8_t week_days, std::uint16_t start_minute, std::uint16_t end_minute) noexcept
+{
+    Week_slots slots;
+
+    for (int weekday = 0; weekday < 7; ++weekday)
+    {
+        if ((week_days >> weekday) & 1)
+        {
+            slots.set(weekday, start_minute, end_minute);
+        }
+    }
+
+    return slots;
+}
+
+void hyx::Week_slots::set(int weekday, std::uint16_t start_minute, std::uint16_t end_minute) noexcept
+{
+    // the slots whose first minute is in [start_minute, end_minute).
+    std::size_t first = weekday * day_slots + std::min<std::size_t>((start_minute + slot_minutes - 1) / slot_minutes, day_slots);
+    std::size_t last = weekday * day_slots + std::min<std::size_t>((end_minute + slot_minutes - 1) / slot_minutes, day_slots);
+
+    // a whole word at a time, masking the ends of the range.
+    while (first < last)
+    {
+        std::size_t bits = std::min<std::size_t>(64 - first % 64, last - first);
+        std::uint64_t mask = (bits == 64) ? ~std::uint64_t{ 0 } : ((std::uint64_t{ 1 } << bits) - 1) << (first % 64);
+
+        this->words[first / 64] |= mask;
+        first += bits;
+    }
+}
+
+bool hyx::Week_slots::test(std::size_t slot) const noexcept
+{
+    return (this->words[slot / 64] >> (slot % 64)) & 1;
+}
+
+std::size_t hyx::Week_slots::count() const noexcept
+{
+    std::size_t total = 0;
+
+    for (std::uint64_t word : this->words)
+    {
+        total += popcount(word);
+    }
+
+    return total;
+}
+
+hyx::Week_slots& hyx::Week_slots::operator|=(const Week_slots& other) noexcept
+{
+    for (std::size_t i = 0; i < word_count; ++i)
+    {
+        this->words[i] |= other.words[i];
+    }
+
+    return *this;
+}
+
+hyx::Week_slots& hyx::Week_slots::operator&=(const Week_slots& other) noexcept
+{
+    for (std::size_t i = 0; i < word_count; ++i)
+    {
+        this->words[i] &= other.words[i];
+    }
+
+    return *this;
+}
+
+hyx::Week_slots hyx::Week_slots::operator~() const noexcept
+{
+    Week_slots flipped;
+
+    for (std::size_t i = 0; i < word_count; ++i)
+    {
+        flipped.words[i] = ~this->words[i];
+    }
+
+    flipped.words[word_count - 1] &= last_word_mask;
+
+    return flipped;
+}
+
+void hyx::Utilization::book(Resource_kind kind, const std::string& name, const Schedule& schedule, std::int32_t first_day, std::int32_t last_day)
+{
+    if (name.empty() || schedule.start_minute == Schedule::no_time || schedule.end_minute == Schedule::no_time
+        || schedule.start_minute >= schedule.end_minute)
+    {
+        return;
+    }
+
+    // the days the meeting runs inside the window, open ended where a date is missing.
+    std::int32_t from = std::max(first_day, schedule.start_day);
+    std::int32_t to = std::min(last_day, (schedule.end_day == Schedule::no_date) ? INT32_MAX : schedule.end_day);
+    Week_slots meeting;
+
+    for (int weekday = 0; weekday < 7; ++weekday)
+    {
+        if (schedule.meets_on(weekday) && schedule::has_weekday(from, to, weekday))
+        {
+            meeting.set(weekday, schedule.start_minute, schedule.end_minute);
+        }
+    }
+
+    if (meeting.count() == 0)
+    {
+        return;
+    }
+
+    std::unordered_map<std::string, std::size_t>& names = (kind == Resource_kind::room) ? this->rooms_ : this->instructors_;
+    auto itr = names.find(name);
+
+    if (itr == names.end())
+    {
+        itr = names.emplace(name, this->resources_.size()).first;
+        this->resources_.push_back({ name, kind, 0, {}, {}, {} });
+    }
+
+    Resource& resource = this->resources_[itr->second];
+    Week_slots taken = resource.occupied;
+
+    taken &= meeting;
+
+    // slots taken again are double booked only where an earlier meeting runs on the same weekday of a shared date.
+    if (taken.count() != 0)
+    {
+        for (const Booking& booking : resource.bookings)
+        {
+            std::int32_t shared_from = std::max(from, booking.first_day);
+            std::int32_t shared_to = std::min(to, booking.last_day);
+            std::uint8_t shared_days = 0;
+
+            for (int weekday = 0; weekday < 7; ++weekday)
+            {
+                if (schedule::has_weekday(shared_from, shared_to, weekday))
+                {
+                    shared_days |= static_cast<std::uint8_t>(1 << weekday);
+                }
+            }
+
+            if (shared_days != 0)
+            {
+                Week_slots both = Week_slots::hours(shared_days, 0, 24 * 60);
+
+                both &= booking.slots;
+                both &= meeting;
+                resource.double_booked |= both;
+            }
+        }
+    }
+
+    resource.occupied |= meeting;
+    resource.bookings.push_back({ from, to, meeting });
+    ++resource.meetings;
+}
+
+std::vector<hyx::Slot_window> hyx::Utilization::windows(const Week_slots& slots, std::uint16_t min_minutes)
+{
+    std::vector<Slot_window> found;
+
+    for (std::size_t weekday = 0; weekday < 7; ++weekday)
+    {
+        std::size_t day_start = weekday * Week_slots::day_slots;
+        std::size_t day_end = day_start + Week_slots::day_slots;
+        std::size_t slot = day_start;
+
+        while ((slot = next_slot(slots, slot, day_end, true)) != day_end)
+        {
+            std::size_t end = next_slot(slots, slot, day_end, false);
+
+            if ((end - slot) * Week_slots::slot_minutes >= min_minutes)
+            {
+                found.push_back({ static_cast<std::uint8_t>(weekday), static_cast<std::uint16_t>((slot - day_start) * Week_slots::slot_minutes),
+                    static_cast<std::uint16_t>((end - day_start) * Week_slots::slot_minutes) });
+            }
+
+            slot = end;
+        }
+    }
+
+    return found;
+}
+
+hyx::Utilization::Utilization(const std::vector<const Course*>& courses, std::int32_t first_day, std::int32_t last_day) :
+    resources_(),
+    rooms_(),
+    instructors_()
+{
+    for (const Course* course : courses)
+    {
+        this->book(Resource_kind::room, course->get_location(), course->get_schedule(), first_day, last_day);
+        this->book(Resource_kind::instructor, course->get_instructor(), course->get_schedule(), first_day, last_day);
+
+        if (const CourseWLAB* lab = dynamic_cast<const CourseWLAB*>(course))
+        {
+            this->book(Resource_kind::room, lab->get_lab_location(), lab->get_lab_schedule(), first_day, last_day);
+        }
+    }
+}
+
+std::size_t hyx::Utilization::size() const noexcept
+{
+    return this->resources_.size();
+}
+
+std::size_t hyx::Utilization::find(Resource_kind kind, std::string_view name) const
+{
+    const std::unordered_map<std::string, std::size_t>& names = (kind == Resource_kind::room) ? this->rooms_ : this->instructors_;
+    auto itr = names.find(std::string(name));
+
+    return (itr == names.end()) ? npos : itr->second;
+}
+
+const std::string& hyx::Utilization::get_name(std::size_t resource) const noexcept
+{
+    return this->resources_[resource].name;
+}
+
+hyx::Resource_kind hyx::Utilization::get_kind(std::size_t resource) const noexcept
+{
+    return this->resources_[resource].kind;
+}
+
+const hyx::Week_slots& hyx::Utilization::get_occupied(std::size_t resource) const noexcept
+{
+    return this->resources_[resource].occupied;
+}
+
+const hyx::Week_slots& hyx::Utilization::get_double_booked(std::size_t resource) const noexcept
+{
+    return this->resources_[resource].double_booked;
+}
+
+double hyx::Utilization::occupancy(std::size_t resource, const Week_slots& open) const noexcept
+{
+    std::size_t open_slots = 0;
+    std::size_t taken_slots = 0;
+
+    for (std::size_t i = 0; i < Week_slots::word_count; ++i)
+    {
+        open_slots += popcount(open.words[i]);
+        taken_slots += popcount(open.words[i] & this->resources_[resource].occupied.words[i]);
+    }
+
+    return (open_slots != 0) ? static_cast<double>(taken_slots) / open_slots : 0.0;
+}
+
+std::vector<hyx::Slot_window> hyx::Utilization::free_windows(std::size_t resource, const Week_slots& open, std::uint16_t min_minutes) const
+{
+    Week_slots free = ~this->resources_[resource].occupied;
+
+    free &= open;
+
+    return windows(free, min_minutes);
+}
+
+std::vector<hyx::Slot_window> hyx::Utilization::double_bookings(std::size_t resource) const
+{
+    return windows(this->resources_[resource].double_booked, Week_slots::slot_minutes);
+}
+
+std::vector<hyx::Resource_usage> hyx::Utilization::report(const Week_slots& open) const
+{
+    std::vector<Resource_usage> usage;
+
+    usage.reserve(this->resources_.size());
+
+    for (std::size_t i = 0; i < this->resources_.size(); ++i)
+    {
+        const Resource& resource = this->resources_[i];
+
+        usage.push_back({ resource.name, resource.kind, resource.meetings, resource.occupied.count() * Week_slots::slot_minutes,
+            resource.double_booked.count() * Week_slots::slot_minutes, this->occupancy(i, open) });
+    }
+
+    return usage;
+}
@@ -0,0 +1,153 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+#ifndef HYX_UTILIZATION_H
+#define HYX_UTILIZATION_H
+
+#include <array> // array
+#include <climits> // INT32_MIN, INT32_MAX
+#include <cstddef> // size_t
+#include <cstdint> // uint8_t, uint16_t, uint64_t
+#include <string> // string
+#include <string_view> // string_view
+#include <unordered_map> // unordered_map
+#include <vector> // vector
+
+#include "hyx_course.h"
+
+
+namespace hyx
+{
+    // one bit per five minutes of a week, from sunday 00:00; a day is 288 slots and may start mid word.
+    // a slot is taken when the meeting is on at its first minute, so meetings that only touch never share one and a meeting
+    // shorter than a slot may take none.
+    class Week_slots
+    {
+    public:
+
+        static constexpr std::uint16_t slot_minutes = 5;
+        static constexpr std::size_t day_slots = 24 * 60 / slot_minutes;
+        static constexpr std::size_t word_count = (7 * day_slots + 63) / 64;
+
+        std::array<std::uint64_t, word_count> words{};
+
+        // every weekday in week_days (bits as in Schedule) from start to end minute, the end not included.
+        [[nodiscard]] static Week_slots hours(std::uint8_t week_days, std::uint16_t start_minute, std::uint16_t end_minute) noexcept;
+
+        // the same for one weekday, 0 for sunday.
+        void set(int weekday, std::uint16_t start_minute, std::uint16_t end_minute) noexcept;
+
+        [[nodiscard]] bool test(std::size_t slot) const noexcept;
+
+        [[nodiscard]] std::size_t count() const noexcept;
+
+        Week_slots& operator|=(const Week_slots& other) noexcept;
+
+        Week_slots& operator&=(const Week_slots& other) noexcept;
+
+        [[nodiscard]] Week_slots operator~() const noexcept;
+
+    };
+
+    // a run of slots inside one day.
+    struct Slot_window
+    {
+        std::uint8_t weekday;
+        std::uint16_t start_minute;
+        std::uint16_t end_minute;
+    };
+
+    enum class Resource_kind : std::uint8_t
+    {
+        room,
+        instructor
+    };
+
+    struct Resource_usage
+    {
+        std::string name;
+        Resource_kind kind;
+        std::size_t meetings;
+        std::size_t occupied_minutes;
+        std::size_t double_booked_minutes;
+
+        // share of the open slots that are taken.
+        double occupancy;
+    };
+
+    // a weekly picture of every room and instructor: which slots they are taken, and which are taken more than once.
+    // rooms are the location of each lecture and the lab location of each lab; instructors only teach the lectures.
+    // occupied folds every week of the window together, but two meetings are only double booked if their dates overlap.
+    class Utilization
+    {
+    private:
+
+        // a meeting as booked: the days it runs inside the window and the slots it takes.
+        struct Booking
+        {
+            std::int32_t first_day;
+            std::int32_t last_day;
+            Week_slots slots;
+        };
+
+        struct Resource
+        {
+            std::string name;
+            Resource_kind kind;
+            std::size_t meetings;
+            Week_slots occupied;
+
+            // slots a second meeting landed on, on a weekday both of them run on the same date.
+            Week_slots double_booked;
+            std::vector<Booking> bookings;
+        };
+
+        std::vector<Resource> resources_;
+        std::unordered_map<std::string, std::size_t> rooms_;
+        std::unordered_map<std::string, std::size_t> instructors_;
+
+        void book(Resource_kind kind, const std::string& name, const Schedule& schedule, std::int32_t first_day, std::int32_t last_day);
+
+        // runs of set bits of slots that are at least min_minutes long, cut at midnight.
+        [[nodiscard]] static std::vector<Slot_window> windows(const Week_slots& slots, std::uint16_t min_minutes);
+
+    public:
+
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        // only meetings whose dates reach into [first_day, last_day] (days since 1970-01-01) are counted, so a term or a
+        // single week can be looked at alone; meetings without a time, and resources with an empty name, are left out.
+        explicit Utilization(const std::vector<const Course*>& courses, std::int32_t first_day = INT32_MIN, std::int32_t last_day = INT32_MAX);
+
+        [[nodiscard]] std::size_t size() const noexcept;
+
+        // npos if nothing was booked to that name.
+        [[nodiscard]] std::size_t find(Resource_kind kind, std::string_view name) const;
+
+        [[nodiscard]] const std::string& get_name(std::size_t resource) const noexcept;
+
+        [[nodiscard]] Resource_kind get_kind(std::size_t resource) const noexcept;
+
+        [[nodiscard]] const Week_slots& get_occupied(std::size_t resource) const noexcept;
+
+        [[nodiscard]] const Week_slots& get_double_booked(std::size_t resource) const noexcept;
+
+        // taken slots over open slots, 0 if nothing is open.
+        [[nodiscard]] double occupancy(std::size_t resource, const Week_slots& open) const noexcept;
+
+        // open stretches where the resource is free, at least min_minutes long.
+        [[nodiscard]] std::vector<Slot_window> free_windows(std::size_t resource, const Week_slots& open, std::uint16_t min_minutes = Week_slots::slot_minutes) const;
+
+        [[nodiscard]] std::vector<Slot_window> double_bookings(std::size_t resource) const;
+
+        // one line per resource, in the order they were first booked.
+        [[nodiscard]] std::vector<Resource_usage> report(const Week_slots& open) const;
+
+    };
+
+} // hyx
+
+#endif // !HYX_UTILIZATION_H
@@ -0,0 +1,723 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+// benchmarks for the course library over synthetic gradebooks; every result is printed as one JSON object per line.
+//
+//     g++ -std=c++17 -O2 -pthread -IC++ C++/*.cpp C++/tools/hyx_bench.cpp -o hyx_bench
+//     ./hyx_bench --sizes=1000,100000 --threads=4 > results.jsonl
+
+#include "hyx_course.h"
+#include "hyx_gradebook.h"
+#include "hyx_json.h"
+#include "hyx_kernel.h"
+#include "hyx_parallel.h"
+#include "hyx_stats.h"
+
+#include <algorithm> //min, max, min_element, transform
+#include <atomic> //atomic, memory_order_relaxed
+#include <chrono> //steady_clock, duration
+#include <cstdint> //uint64_t
+#include <cstdio> //fprintf, fwrite
+#include <cstddef> //max_align_t
+#include <cstdlib> //malloc, free, strtod, strtoull
+#include <cstring> //strncmp, strlen
+#include <functional> //divides
+#include <iostream> //cerr
+#include <iterator> //back_inserter, distance
+#include <limits> //numeric_limits
+#include <new> //bad_alloc
+#include <numeric> //accumulate
+#include <streambuf> //streambuf
+#include <string> //string, to_string
+#include <tuple> //tuple, get
+#include <unordered_map> //unordered_map
+#include <vector> //vector
+
+namespace
+{
+    // bytes handed out by operator new and not yet deleted, for the memory benchmarks.
+    std::atomic<std::size_t> live_bytes{ 0 };
+
+    // each block keeps its size in front of it so delete can take it off again.
+    constexpr std::size_t header_bytes = alignof(std::max_align_t);
+}
+
+// kept out of line, so the compiler does not pair a malloc it can see with the free in delete.
+[[gnu::noinline]] void* operator new(std::size_t size)
+{
+    char* block = static_cast<char*>(std::malloc(size + header_bytes));
+
+    if (block == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    *reinterpret_cast<std::size_t*>(block) = size;
+    live_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    return block + header_bytes;
+}
+
+[[gnu::noinline]] void operator delete(void* pointer) noexcept
+{
+    if (pointer != nullptr)
+    {
+        char* block = static_cast<char*>(pointer) - header_bytes;
+
+        live_bytes.fetch_sub(*reinterpret_cast<std::size_t*>(block), std::memory_order_relaxed);
+        std::free(block);
+    }
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    operator delete(pointer);
+}
+
+namespace
+{
+    struct Config
+    {
+        std::vector<std::size_t> sizes;
+        std::size_t categories;
+        std::size_t scores;
+
+        // shares of categories that drop grades, courses with a replacement rule and point based courses.
+        double drops;
+        double replace;
+        double point_based;
+
+        unsigned int threads;
+        std::size_t repeat;
+        std::uint64_t seed;
+    };
+
+    // courses are built and graded this many at a time, so the grades of one block are drawn before the clock starts.
+    constexpr std::size_t block_courses = 4096;
+
+    std::uint64_t mix(std::uint64_t x) noexcept
+    {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+
+        return x ^ (x >> 31);
+    }
+
+    // a uniform draw in [0, 1) that depends only on the seed, the course and the draw; course i is the same at every size.
+    double uniform(const Config& config, std::size_t course, std::uint64_t draw) noexcept
+    {
+        return static_cast<double>(mix(config.seed ^ mix(course * 0x100000001B3ull + draw)) >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    hyx::Course make_course(const Config& config, std::size_t index)
+    {
+        static const hyx::Shared_scale scales[] = {
+            hyx::scale::shared::STD(), hyx::scale::shared::G11(), hyx::scale::shared::U12(), hyx::scale::shared::U11(), hyx::scale::shared::PF()
+        };
+
+        hyx::Course course("Synthetic Course " + std::to_string(index), static_cast<long>(10000 + index), 1 + static_cast<int>(index % 4),
+            scales[index % 5], "Synthetic University", "Hall " + std::to_string(index % 97), "Instructor " + std::to_string(index % 211),
+            "generated", { false, true, false, true, false, true, false, false }, { 2021, 8, 23 }, { 2021, 12, 17 }, { 9, 30 }, { 10, 45 });
+
+        if (uniform(config, index, 0) < config.point_based)
+        {
+            course.set_point_based(static_cast<double>(config.categories * config.scores * 10));
+        }
+
+        bool replaces = uniform(config, index, 1) < config.replace && config.categories > 1;
+
+        for (std::size_t c = 0; c < config.categories; ++c)
+        {
+            // equal weights, with the last one taking whatever rounding left over.
+            double weight = (c + 1 == config.categories) ? 1.0 - (config.categories - 1) * (1.0 / config.categories) : 1.0 / config.categories;
+            int drops = (uniform(config, index, 2 + c) < config.drops) ? 1 + static_cast<int>(index % 2) : 0;
+            std::pair<int, std::string> replace = (replaces && c == 0) ? std::pair<int, std::string>(1, "CAT" + std::to_string(config.categories - 1)) : std::pair<int, std::string>(0, "");
+
+            course.add_category("cat" + std::to_string(c), weight, drops, replace);
+        }
+
+        return course;
+    }
+
+    // the grades of one course, category by category.
+    void make_grades(const Config& config, std::size_t index, std::vector<hyx::Course::Grade_record>& grades)
+    {
+        grades.clear();
+
+        for (std::uint32_t c = 0; c < config.categories; ++c)
+        {
+            for (std::size_t s = 0; s < config.scores; ++s)
+            {
+                std::uint64_t draw = 1000 + c * config.scores + s;
+                double possible = (s % 3 == 0) ? 100.0 : 10.0;
+
+                grades.push_back({ hyx::Category_id(c), possible * (0.4 + 0.6 * uniform(config, index, draw)), possible });
+            }
+        }
+    }
+
+    // counts what operator<< writes without keeping it.
+    class Counting_buffer
+        : public std::streambuf
+    {
+    private:
+
+        std::size_t count_;
+
+    protected:
+
+        int_type overflow(int_type c) override
+        {
+            ++this->count_;
+
+            return traits_type::not_eof(c);
+        }
+
+        std::streamsize xsputn(const char*, std::streamsize count) override
+        {
+            this->count_ += static_cast<std::size_t>(count);
+
+            return count;
+        }
+
+    public:
+
+        Counting_buffer() : count_(0) {}
+
+        [[nodiscard]] std::size_t count() const noexcept { return this->count_; }
+    };
+
+    typedef std::chrono::steady_clock Clock;
+
+    double seconds_since(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // one JSON line: what ran, how big it was, how long it took and a checksum of what it computed.
+    void report(const Config& config, const char* benchmark, std::size_t courses, unsigned int threads, std::size_t operations, double seconds, double checksum)
+    {
+        std::string line = "{\"benchmark\":";
+
+        hyx::json::append_string(line, benchmark);
+        line.append(",\"courses\":");
+        hyx::json::append_number(line, static_cast<double>(courses));
+        line.append(",\"categories\":");
+        hyx::json::append_number(line, static_cast<double>(config.categories));
+        line.append(",\"scores\":");
+        hyx::json::append_number(line, static_cast<double>(config.scores));
+        line.append(",\"threads\":");
+        hyx::json::append_number(line, threads);
+        line.append(",\"kernel\":");
+        hyx::json::append_string(line, hyx::kernel::instruction_set());
+        line.append(",\"operations\":");
+        hyx::json::append_number(line, static_cast<double>(operations));
+        line.append(",\"seconds\":");
+        hyx::json::append_number(line, seconds);
+        line.append(",\"ns_per_operation\":");
+        hyx::json::append_number(line, (operations != 0) ? seconds * 1e9 / static_cast<double>(operations) : 0.0);
+        line.append(",\"checksum\":");
+        hyx::json::append_number(line, checksum);
+        line.append("}\n");
+
+        std::fwrite(line.data(), 1, line.size(), stdout);
+        std::fflush(stdout);
+    }
+
+    // one JSON line for a memory benchmark: the heap bytes held and their share per course.
+    void report_memory(const Config& config, const char* benchmark, std::size_t courses, std::size_t bytes)
+    {
+        std::string line = "{\"benchmark\":";
+
+        hyx::json::append_string(line, benchmark);
+        line.append(",\"courses\":");
+        hyx::json::append_number(line, static_cast<double>(courses));
+        line.append(",\"categories\":");
+        hyx::json::append_number(line, static_cast<double>(config.categories));
+        line.append(",\"scores\":");
+        hyx::json::append_number(line, static_cast<double>(config.scores));
+        line.append(",\"bytes\":");
+        hyx::json::append_number(line, static_cast<double>(bytes));
+        line.append(",\"bytes_per_course\":");
+        hyx::json::append_number(line, (courses != 0) ? static_cast<double>(bytes) / static_cast<double>(courses) : 0.0);
+        line.append("}\n");
+
+        std::fwrite(line.data(), 1, line.size(), stdout);
+        std::fflush(stdout);
+    }
+
+    // the fastest of config.repeat runs of body, which returns its checksum.
+    template <class Body>
+    void repeat(const Config& config, const char* benchmark, std::size_t courses, unsigned int threads, std::size_t operations, Body body)
+    {
+        double best = std::numeric_limits<double>::infinity();
+        double checksum = 0.0;
+
+        for (std::size_t r = 0; r < config.repeat; ++r)
+        {
+            Clock::time_point start = Clock::now();
+
+            checksum = body();
+            best = std::min(best, seconds_since(start));
+        }
+
+        report(config, benchmark, courses, threads, operations, best, checksum);
+    }
+
+    double grade_sum(const std::vector<hyx::Course>& courses)
+    {
+        double sum = 0.0;
+
+        for (const auto& course : courses)
+        {
+            sum += course.get_grade();
+        }
+
+        return sum;
+    }
+
+    // the drop loop every add_grade used to run again: copy the category, erase the lowest percentage drops times, sum the rest.
+    double rescan_kept(const std::vector<double>& earned, const std::vector<double>& possible, int drops)
+    {
+        std::vector<double> points_earned(earned);
+        std::vector<double> points_poss(possible);
+        std::vector<double> points_perc;
+
+        std::transform(points_earned.begin(), points_earned.end(), points_poss.begin(), std::back_inserter(points_perc), std::divides<double>());
+
+        for (int i = 0; i < drops && points_perc.size() != 0; ++i)
+        {
+            std::ptrdiff_t min_index = std::distance(points_perc.begin(), std::min_element(points_perc.begin(), points_perc.end()));
+
+            points_perc.erase(points_perc.begin() + min_index);
+            points_earned.erase(points_earned.begin() + min_index);
+            points_poss.erase(points_poss.begin() + min_index);
+        }
+
+        return std::accumulate(points_earned.begin(), points_earned.end(), 0.0) / std::accumulate(points_poss.begin(), points_poss.end(), 0.0);
+    }
+
+    // one category that drops its lowest grades ("10 of 60"), filled a grade at a time: the incremental window against the old rescan.
+    void run_drops(const Config& config)
+    {
+        for (std::size_t count : { 10, 100, 10000 })
+        {
+            Config shape = config;
+            std::size_t courses = std::max<std::size_t>(1, 10000 / count);
+            int drops = static_cast<int>(std::max<std::size_t>(1, std::min<std::size_t>(10, count / 6)));
+            std::vector<double> earned(courses * count);
+
+            shape.categories = 1;
+            shape.scores = count;
+
+            for (std::size_t i = 0; i < earned.size(); ++i)
+            {
+                earned[i] = 100.0 * uniform(config, i / count, i % count);
+            }
+
+            repeat(shape, "drops_add_grade", courses, 1, courses * count, [&] {
+                double checksum = 0.0;
+
+                for (std::size_t c = 0; c < courses; ++c)
+                {
+                    hyx::Course course("Drops", 1, 3, hyx::scale::shared::STD(), "", "", "", "", {}, { 2021, 8, 23 }, { 2021, 12, 17 });
+                    hyx::Category_id id = course.add_category("quizzes", 1.0, drops);
+
+                    for (std::size_t s = 0; s < count; ++s)
+                    {
+                        course.add_grade(id, earned[c * count + s], 100.0);
+                    }
+
+                    checksum += course.get_grade();
+                }
+
+                return checksum;
+                });
+
+            // quadratic in the grades, so it runs once however many repeats were asked for.
+            Clock::time_point start = Clock::now();
+            double checksum = 0.0;
+
+            for (std::size_t c = 0; c < courses; ++c)
+            {
+                std::vector<double> course_earned;
+                std::vector<double> course_possible;
+                double kept = 0.0;
+
+                for (std::size_t s = 0; s < count; ++s)
+                {
+                    course_earned.push_back(earned[c * count + s]);
+                    course_possible.push_back(100.0);
+                    kept = rescan_kept(course_earned, course_possible, drops);
+                }
+
+                checksum += (course_earned.size() > static_cast<std::size_t>(drops)) ? kept * 100 : 0.0;
+            }
+
+            report(shape, "drops_rescan", courses, 1, courses * count, seconds_since(start), checksum);
+        }
+    }
+
+    // how scores were kept before the gradebook: earned, possible, weight, drops, replacement, one map node per category.
+    typedef std::unordered_map<std::string, std::tuple<std::vector<double>, std::vector<double>, double, int, std::pair<int, std::string>>> Map_layout;
+
+    // the weighted grade of every course from 1 to 10k scores, read from the old per-category map and from the flat gradebook.
+    void run_layout(const Config& config)
+    {
+        for (std::size_t count : { 1, 10, 100, 1000, 10000 })
+        {
+            Config shape = config;
+            std::size_t categories = std::min(config.categories, count);
+            std::size_t courses = std::max<std::size_t>(1, std::min<std::size_t>(100000, 1000000 / count));
+            std::vector<Map_layout> maps(courses);
+            std::vector<hyx::Gradebook> books(courses);
+            std::vector<double> weights(categories, 1.0 / categories);
+
+            shape.categories = categories;
+            shape.scores = count / categories;
+
+            for (std::size_t c = 0; c < courses; ++c)
+            {
+                for (std::size_t k = 0; k < categories; ++k)
+                {
+                    auto& entry = maps[c]["CAT" + std::to_string(k)];
+
+                    std::get<2>(entry) = weights[k];
+                    books[c].add_category();
+                }
+
+                for (std::size_t s = 0; s < count; ++s)
+                {
+                    std::uint32_t k = static_cast<std::uint32_t>(s % categories);
+                    double earned = 10.0 * uniform(config, c, s);
+
+                    std::get<0>(maps[c]["CAT" + std::to_string(k)]).push_back(earned);
+                    std::get<1>(maps[c]["CAT" + std::to_string(k)]).push_back(10.0);
+                    books[c].push_back(k, earned, 10.0);
+                }
+            }
+
+            repeat(shape, "layout_map", courses, 1, courses * count, [&] {
+                double checksum = 0.0;
+
+                for (const auto& map : maps)
+                {
+                    for (const auto& itr : map)
+                    {
+                        double earned = std::accumulate(std::get<0>(itr.second).begin(), std::get<0>(itr.second).end(), 0.0);
+                        double possible = std::accumulate(std::get<1>(itr.second).begin(), std::get<1>(itr.second).end(), 0.0);
+
+                        checksum += std::get<2>(itr.second) * (earned / possible);
+                    }
+                }
+
+                return checksum;
+                });
+
+            repeat(shape, "layout_flat", courses, 1, courses * count, [&] {
+                double checksum = 0.0;
+
+                for (const auto& book : books)
+                {
+                    for (std::uint32_t k = 0; k < categories; ++k)
+                    {
+                        std::pair<double, double> sums = hyx::kernel::sum_pair(book.earned(k), book.possible(k), book.size(k));
+
+                        checksum += weights[k] * (sums.first / sums.second);
+                    }
+                }
+
+                return checksum;
+                });
+        }
+    }
+
+    void run(const Config& config, std::size_t size)
+    {
+        std::vector<hyx::Course> courses;
+        std::vector<hyx::Course::Grade_record> grades;
+        std::size_t score_count = size * config.categories * config.scores;
+        double build_seconds = 0.0;
+        double add_seconds = 0.0;
+        std::size_t start_bytes = live_bytes.load();
+
+        courses.reserve(size);
+
+        // build, then add_grade one score at a time.
+        for (std::size_t first = 0; first < size; first += block_courses)
+        {
+            std::size_t last = std::min(size, first + block_courses);
+            Clock::time_point start = Clock::now();
+
+            for (std::size_t i = first; i < last; ++i)
+            {
+                courses.push_back(make_course(config, i));
+            }
+
+            build_seconds += seconds_since(start);
+
+            std::vector<std::vector<hyx::Course::Grade_record>> block(last - first);
+
+            for (std::size_t i = first; i < last; ++i)
+            {
+                make_grades(config, i, block[i - first]);
+            }
+
+            start = Clock::now();
+
+            for (std::size_t i = first; i < last; ++i)
+            {
+                for (const auto& grade : block[i - first])
+                {
+                    courses[i].add_grade(grade.category, grade.earned, grade.possible);
+                }
+            }
+
+            add_seconds += seconds_since(start);
+        }
+
+        report(config, "build", size, 1, size, build_seconds, static_cast<double>(courses.size()));
+        report(config, "add_grade", size, 1, score_count, add_seconds, grade_sum(courses));
+        report_memory(config, "memory_courses", size, live_bytes.load() - start_bytes);
+
+        // what the scales alone took when every course kept its own copy of the scale's map, before they were shared.
+        {
+            const hyx::Grade_scale* scales[] = { &hyx::scale::STD, &hyx::scale::G11, &hyx::scale::U12, &hyx::scale::U11, &hyx::scale::PF };
+            std::size_t copy_start = live_bytes.load();
+            std::vector<hyx::Grade_scale> copies;
+
+            copies.reserve(size);
+
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                copies.push_back(*scales[i % 5]);
+            }
+
+            report_memory(config, "memory_scale_copies", size, live_bytes.load() - copy_start);
+        }
+
+        repeat(config, "recompute", size, 1, size, [&] {
+            for (auto& course : courses)
+            {
+                course.recompute();
+            }
+
+            return grade_sum(courses);
+            });
+
+        // scaling from one thread to config.threads, doubling in between.
+        std::vector<unsigned int> thread_counts;
+
+        for (unsigned int threads = 1; threads < config.threads; threads *= 2)
+        {
+            thread_counts.push_back(threads);
+        }
+
+        thread_counts.push_back(config.threads);
+
+        for (unsigned int threads : thread_counts)
+        {
+            repeat(config, "recompute_all", size, threads, size, [&] {
+                hyx::recompute_all(courses, threads);
+
+                return grade_sum(courses);
+                });
+        }
+
+        repeat(config, "get_GPA", size, 1, size, [&] {
+            return static_cast<double>(hyx::get_GPA(courses));
+            });
+
+        repeat(config, "accumulate_GPA", size, config.threads, size, [&] {
+            return static_cast<double>(hyx::accumulate_GPA(courses, config.threads).get_GPA());
+            });
+
+        // every report into one reused string, so only the formatting is timed.
+        repeat(config, "render", size, 1, size, [&] {
+            std::string report;
+            std::size_t bytes = 0;
+
+            for (const auto& course : courses)
+            {
+                report.clear();
+                course.render(report);
+                bytes += report.size();
+            }
+
+            return static_cast<double>(bytes);
+            });
+
+        repeat(config, "operator<<", size, 1, size, [&] {
+            Counting_buffer buffer;
+            std::ostream os(&buffer);
+
+            for (const auto& course : courses)
+            {
+                os << course;
+            }
+
+            return static_cast<double>(buffer.count());
+            });
+
+        // the same courses again, each graded with one add_grades batch.
+        courses.clear();
+        courses.shrink_to_fit();
+        courses.reserve(size);
+
+        double batch_seconds = 0.0;
+
+        for (std::size_t first = 0; first < size; first += block_courses)
+        {
+            std::size_t last = std::min(size, first + block_courses);
+            std::vector<std::vector<hyx::Course::Grade_record>> block(last - first);
+
+            for (std::size_t i = first; i < last; ++i)
+            {
+                courses.push_back(make_course(config, i));
+                make_grades(config, i, block[i - first]);
+            }
+
+            Clock::time_point start = Clock::now();
+
+            for (std::size_t i = first; i < last; ++i)
+            {
+                courses[i].add_grades(block[i - first]);
+            }
+
+            batch_seconds += seconds_since(start);
+        }
+
+        report(config, "add_grades", size, 1, score_count, batch_seconds, grade_sum(courses));
+    }
+
+    // "--name=value"; null if arg is not that option.
+    const char* option(const char* arg, const char* name)
+    {
+        std::size_t length = std::strlen(name);
+
+        return (std::strncmp(arg, name, length) == 0 && arg[length] == '=') ? arg + length + 1 : nullptr;
+    }
+
+    bool parse_sizes(const char* text, std::vector<std::size_t>& sizes)
+    {
+        sizes.clear();
+
+        while (*text != '\0')
+        {
+            char* end = nullptr;
+            unsigned long long size = std::strtoull(text, &end, 10);
+
+            if (end == text || size == 0 || (*end != ',' && *end != '\0'))
+            {
+                return false;
+            }
+
+            sizes.push_back(static_cast<std::size_t>(size));
+            text = (*end == ',') ? end + 1 : end;
+        }
+
+        return not sizes.empty();
+    }
+
+    void usage()
+    {
+        std::fprintf(stderr,
+            "usage: hyx_bench [options]\n"
+            "  --sizes=N,N,...     courses per run (1000,100000,1000000)\n"
+            "  --categories=N      categories per course (4)\n"
+            "  --scores=N          scores per category (8)\n"
+            "  --drops=S           share of categories that drop grades (0.25)\n"
+            "  --replace=S         share of courses with a replacement rule (0.25)\n"
+            "  --point-based=S     share of point based courses (0.2)\n"
+            "  --threads=N         threads for the parallel benchmarks, 0 for every core (0)\n"
+            "  --repeat=N          runs of each read-only benchmark, the fastest is kept (3)\n"
+            "  --seed=N            seed of the synthetic data (1)\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Config config{ { 1000, 100000, 1000000 }, 4, 8, 0.25, 0.25, 0.2, 0, 3, 1 };
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        const char* value = nullptr;
+        bool good = true;
+
+        if ((value = option(arg, "--sizes")))
+        {
+            good = parse_sizes(value, config.sizes);
+        }
+        else if ((value = option(arg, "--categories")))
+        {
+            config.categories = std::strtoull(value, nullptr, 10);
+            good = config.categories != 0;
+        }
+        else if ((value = option(arg, "--scores")))
+        {
+            config.scores = std::strtoull(value, nullptr, 10);
+        }
+        else if ((value = option(arg, "--drops")))
+        {
+            config.drops = std::strtod(value, nullptr);
+        }
+        else if ((value = option(arg, "--replace")))
+        {
+            config.replace = std::strtod(value, nullptr);
+        }
+        else if ((value = option(arg, "--point-based")))
+        {
+            config.point_based = std::strtod(value, nullptr);
+        }
+        else if ((value = option(arg, "--threads")))
+        {
+            config.threads = static_cast<unsigned int>(std::strtoul(value, nullptr, 10));
+        }
+        else if ((value = option(arg, "--repeat")))
+        {
+            config.repeat = std::strtoull(value, nullptr, 10);
+            good = config.repeat != 0;
+        }
+        else if ((value = option(arg, "--seed")))
+        {
+            config.seed = std::strtoull(value, nullptr, 10);
+        }
+        else
+        {
+            good = false;
+        }
+
+        if (not good)
+        {
+            usage();
+
+            return 1;
+        }
+    }
+
+    if (config.threads == 0)
+    {
+        config.threads = hyx::default_threads();
+    }
+
+    run_drops(config);
+    run_layout(config);
+
+    for (std::size_t size : config.sizes)
+    {
+        run(config, size);
+    }
+
+    // built with -DHYX_STATS, where the time went inside the library; kept off stdout so the results stay one object per line.
+    if (hyx::stats::enabled())
+    {
+        std::cerr << hyx::stats::collect();
+    }
+
+    return 0;
+}
@@ -0,0 +1,2037 @@
+/* Copyright 2021 Michael Pollak.
+ *
+ * Use of this source code is governed by an MIT-style
+ * licence that can be found in the LICENSE file.
+ */
+
+// checks for the course library; prints every failure and exits with 1 if there was any.
+//
+//     g++ -std=c++17 -O2 -pthread -IC++ C++/*.cpp C++/tools/hyx_test.cpp -o hyx_test
+//     ./hyx_test --seed=7
+
+#include "hyx_conflict.h"
+#include "hyx_course.h"
+#include "hyx_csv.h"
+#include "hyx_json.h"
+#include "hyx_kernel.h"
+#include "hyx_parallel.h"
+#include "hyx_projection.h"
+#include "hyx_schedule.h"
+#include "hyx_snapshot.h"
+#include "hyx_stats.h"
+#include "hyx_transcript.h"
+#include "hyx_utilization.h"
+
+#include <algorithm> //min_element, equal, sort, all_of
+#include <array> //array
+#include <atomic> //atomic
+#include <climits> //INT32_MIN, INT32_MAX
+#include <cmath> //abs, floor, isnan
+#include <cstddef> //offsetof
+#include <cstdint> //uint64_t
+#include <cstdio> //printf, fopen, fread, fwrite, fclose, remove
+#include <cstdlib> //strtoull, malloc, free, mkdtemp, mkstemp
+#include <cstring> //memcmp, memcpy, strcmp, strncmp, strlen
+#include <iterator> //distance
+#include <limits> //numeric_limits
+#include <list> //list
+#include <memory> //unique_ptr, make_unique
+#include <new> //bad_alloc
+#include <numeric> //accumulate, iota
+#include <string> //string, to_string
+#include <tuple> //tie
+#include <utility> //pair
+#include <vector> //vector
+#include <dirent.h> //opendir, readdir, closedir
+#include <unistd.h> //rmdir, close
+
+namespace
+{
+    // every byte operator new has handed out, so a check can see what a step allocated.
+    std::atomic<std::size_t> allocated_bytes{ 0 };
+}
+
+// kept out of line, so the compiler does not pair a malloc it can see with the free in delete.
+[[gnu::noinline]] void* operator new(std::size_t size)
+{
+    void* block = std::malloc((size == 0) ? 1 : size);
+
+    if (block == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    return block;
+}
+
+[[gnu::noinline]] void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    operator delete(pointer);
+}
+
+namespace
+{
+    std::size_t failures = 0;
+
+    void check(bool passed, const std::string& what)
+    {
+        if (not passed)
+        {
+            ++failures;
+            std::printf("FAIL %s\n", what.c_str());
+        }
+    }
+
+    // the same bits, with every NaN counted as the same NaN.
+    bool same(double lhs, double rhs) noexcept
+    {
+        return (std::isnan(lhs) && std::isnan(rhs)) || std::memcmp(&lhs, &rhs, sizeof(double)) == 0;
+    }
+
+    class Random
+    {
+    private:
+
+        std::uint64_t state_;
+
+    public:
+
+        explicit Random(std::uint64_t seed) : state_(seed) {}
+
+        std::uint64_t next() noexcept
+        {
+            std::uint64_t x = (this->state_ += 0x9E3779B97F4A7C15ull);
+
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+
+            return x ^ (x >> 31);
+        }
+
+        // in [0, bound)
+        std::size_t below(std::size_t bound) noexcept
+        {
+            return static_cast<std::size_t>(this->next() % bound);
+        }
+
+        // in [0, 1)
+        double uniform() noexcept
+        {
+            return static_cast<double>(this->next() >> 11) * (1.0 / 9007199254740992.0);
+        }
+    };
+
+    // what make_course chose, so a check can work the grade out on its own.
+    struct Category_spec
+    {
+        double weight;
+        int drops;
+
+        // grades replaced by the first grade of category replace_from, if replacements is not 0.
+        int replacements;
+        std::size_t replace_from;
+    };
+
+    struct Course_spec
+    {
+        bool point_based;
+        double base_points;
+        const hyx::Compiled_scale* scale;
+        std::vector<Category_spec> categories;
+    };
+
+    hyx::Course make_course(Random& random, std::size_t index, Course_spec* spec = nullptr)
+    {
+        Course_spec chosen{ false, 0.0, nullptr, {} };
+
+        static const hyx::Shared_scale scales[] = {
+            hyx::scale::shared::STD(), hyx::scale::shared::G11(), hyx::scale::shared::U12(), hyx::scale::shared::U11()
+        };
+
+        const hyx::Shared_scale& scale = scales[random.below(4)];
+        hyx::Course course("Test Course " + std::to_string(index), static_cast<long>(index), 3, scale, "Test University",
+            "Hall", "Instructor", "", { false, true, false, true, false, false, false, false }, { 2021, 8, 23 }, { 2021, 12, 17 });
+
+        chosen.scale = &*scale;
+
+        if (random.below(4) == 0)
+        {
+            chosen.base_points = 100.0 * (1 + random.below(20));
+            chosen.point_based = true;
+            course.set_point_based(chosen.base_points);
+        }
+
+        std::size_t categories = 1 + random.below(5);
+
+        for (std::size_t c = 0; c < categories; ++c)
+        {
+            double weight = (c + 1 == categories) ? 1.0 - (categories - 1) * (1.0 / categories) : 1.0 / categories;
+            int drops = (random.below(2) == 0) ? static_cast<int>(random.below(4)) : 0;
+            std::pair<int, std::string> replace(0, "");
+            std::size_t replace_from = 0;
+
+            if (categories > 1 && random.below(3) == 0)
+            {
+                int replacements = 1 + static_cast<int>(random.below(2));
+
+                replace_from = random.below(categories);
+                replace = { replacements, "CAT" + std::to_string(replace_from) };
+            }
+
+            course.add_category("cat" + std::to_string(c), weight, drops, replace);
+            chosen.categories.push_back({ weight, drops, replace.first, replace_from });
+        }
+
+        if (spec != nullptr)
+        {
+            *spec = chosen;
+        }
+
+        return course;
+    }
+
+    // grades in a random category order, with ties, zeros and the odd ungraded 0/0.
+    std::vector<hyx::Course::Grade_record> make_grades(Random& random, const hyx::Course& course)
+    {
+        std::vector<hyx::Course::Grade_record> grades(random.below(60));
+        std::uint32_t categories = 0;
+
+        while (course.get_category("cat" + std::to_string(categories)))
+        {
+            ++categories;
+        }
+
+        for (auto& grade : grades)
+        {
+            double possible = (random.below(3) == 0) ? 100.0 : 10.0 * (1 + random.below(3));
+            std::size_t kind = random.below(20);
+
+            grade.category = hyx::Category_id(static_cast<std::uint32_t>(random.below(categories)));
+            grade.possible = (kind == 0) ? 0.0 : possible;
+            grade.earned = (kind == 0 || kind == 1) ? 0.0 : (kind == 2) ? possible / 2 : possible * random.uniform();
+        }
+
+        return grades;
+    }
+
+    // the grade the original update_grade worked out: every category's scores copied, the lowest percentage erased drops times
+    // with min_element, then the lowest left replaced while the replacement's percentage is higher, and the rest summed.
+    // three things differ on purpose: ungraded 0/0 scores are the lowest of all, categories are combined in the order they were
+    // added rather than in hash map order, and the replacement lands on the grade it replaces rather than on the position
+    // that grade had before the earlier replacements were erased.
+    double reference_grade(const Course_spec& spec, const std::vector<hyx::Course::Grade_record>& grades)
+    {
+        std::size_t categories = spec.categories.size();
+        std::vector<std::vector<double>> earned(categories);
+        std::vector<std::vector<double>> possible(categories);
+        double total_weight = 0.0;
+
+        for (const auto& grade : grades)
+        {
+            earned[grade.category.index()].push_back(grade.earned);
+            possible[grade.category.index()].push_back(grade.possible);
+        }
+
+        for (const auto& category : spec.categories)
+        {
+            total_weight += category.weight;
+        }
+
+        if (not spec.point_based && not (std::abs(1 - total_weight) < std::numeric_limits<float>::epsilon()))
+        {
+            return -1.0;
+        }
+
+        auto perc = [](double earn, double poss) {
+            double value = earn / poss;
+
+            return (std::isnan(value)) ? -std::numeric_limits<double>::infinity() : value;
+        };
+
+        double final_grade = 0.0;
+        double unused_weight = 0.0;
+        double total_earned = 0.0;
+        double total_possible = 0.0;
+        bool has_grades = false;
+
+        for (std::size_t c = 0; c < categories; ++c)
+        {
+            const Category_spec& category = spec.categories[c];
+            std::vector<double> points_earned(earned[c]);
+            std::vector<double> points_poss(possible[c]);
+
+            if (category.drops > 0 || category.replacements > 0)
+            {
+                std::vector<double> points_perc;
+
+                for (std::size_t i = 0; i < points_earned.size(); ++i)
+                {
+                    points_perc.push_back(perc(points_earned[i], points_poss[i]));
+                }
+
+                for (int i = 0; i < category.drops && not points_perc.empty(); ++i)
+                {
+                    std::ptrdiff_t min_index = std::distance(points_perc.begin(), std::min_element(points_perc.begin(), points_perc.end()));
+
+                    points_perc.erase(points_perc.begin() + min_index);
+                    points_earned.erase(points_earned.begin() + min_index);
+                    points_poss.erase(points_poss.begin() + min_index);
+                }
+
+                // where each percentage left sits in points_earned, which replacements do not shrink.
+                std::vector<std::size_t> position(points_perc.size());
+                std::iota(position.begin(), position.end(), 0);
+
+                const std::vector<double>& from_earned = earned[category.replace_from];
+                const std::vector<double>& from_poss = possible[category.replace_from];
+
+                for (int i = 0; i < category.replacements && not from_earned.empty() && not points_perc.empty(); ++i)
+                {
+                    std::ptrdiff_t min_index = std::distance(points_perc.begin(), std::min_element(points_perc.begin(), points_perc.end()));
+
+                    if (from_earned.front() / from_poss.front() > points_perc[min_index])
+                    {
+                        points_earned[position[min_index]] = from_earned.front();
+                        points_poss[position[min_index]] = from_poss.front();
+                        points_perc.erase(points_perc.begin() + min_index);
+                        position.erase(position.begin() + min_index);
+                    }
+                }
+            }
+
+            if (points_earned.empty())
+            {
+                unused_weight += category.weight;
+            }
+            else if (spec.point_based)
+            {
+                has_grades = true;
+                total_earned += std::accumulate(points_earned.begin(), points_earned.end(), 0.0);
+                total_possible += std::accumulate(points_poss.begin(), points_poss.end(), 0.0);
+            }
+            else
+            {
+                has_grades = true;
+                final_grade += category.weight * (std::accumulate(points_earned.begin(), points_earned.end(), 0.0)
+                    / std::accumulate(points_poss.begin(), points_poss.end(), 0.0));
+            }
+        }
+
+        // a course that kept no grade at all keeps the grade it started with.
+        if (not has_grades)
+        {
+            return -1.0;
+        }
+
+        return (spec.point_based) ? (total_earned / total_possible) * 100 : final_grade * 100 / (1 - unused_weight);
+    }
+
+    // one grade at a time, all at once in a few batches, a copy recomputed from the scores and the original algorithm must all agree bit for bit.
+    void check_incremental(std::uint64_t seed, std::size_t courses)
+    {
+        Random random(seed);
+        std::vector<hyx::Course> recomputed;
+
+        for (std::size_t i = 0; i < courses; ++i)
+        {
+            Course_spec spec;
+            hyx::Course one_by_one = make_course(random, i, &spec);
+            hyx::Course batched = one_by_one;
+            std::vector<hyx::Course::Grade_record> grades = make_grades(random, one_by_one);
+            std::string what = "incremental seed=" + std::to_string(seed) + " course=" + std::to_string(i);
+
+            for (const auto& grade : grades)
+            {
+                one_by_one.add_grade(grade.category, grade.earned, grade.possible);
+            }
+
+            for (std::size_t first = 0; first < grades.size();)
+            {
+                std::size_t last = first + 1 + random.below(grades.size() - first);
+
+                batched.add_grades(std::vector<hyx::Course::Grade_record>(grades.begin() + first, grades.begin() + last));
+                first = last;
+            }
+
+            hyx::Course copy = one_by_one;
+
+            copy.recompute();
+            recomputed.push_back(one_by_one);
+
+            check(same(one_by_one.get_grade(), batched.get_grade()), what + " add_grade " + std::to_string(one_by_one.get_grade())
+                + " != add_grades " + std::to_string(batched.get_grade()));
+            check(same(one_by_one.get_grade(), copy.get_grade()), what + " add_grade " + std::to_string(one_by_one.get_grade())
+                + " != recompute " + std::to_string(copy.get_grade()));
+
+            double reference = reference_grade(spec, grades);
+
+            check(same(one_by_one.get_grade(), reference), what + " add_grade " + std::to_string(one_by_one.get_grade())
+                + " != reference " + std::to_string(reference));
+            // a grade that cannot be worked out keeps the letter from before it, which depends on how the grades came in.
+            if (not std::isnan(one_by_one.get_grade()))
+            {
+                check(one_by_one.get_letter() == copy.get_letter() && one_by_one.get_letter() == batched.get_letter(), what + " letter");
+            }
+
+            check(same(one_by_one.get_grade_points(), copy.get_grade_points()), what + " grade points");
+        }
+
+        std::vector<hyx::Course> original = recomputed;
+
+        hyx::recompute_all(recomputed, 4);
+
+        for (std::size_t i = 0; i < courses; ++i)
+        {
+            check(same(original[i].get_grade(), recomputed[i].get_grade()), "recompute_all seed=" + std::to_string(seed) + " course=" + std::to_string(i));
+        }
+    }
+
+    // copies share their categories until they write; forks recomputed on many threads must not touch each other or the originals.
+    void check_forks(std::uint64_t seed, std::size_t courses)
+    {
+        Random random(seed);
+        std::vector<hyx::Course> originals;
+        std::vector<std::string> reports;
+
+        for (std::size_t i = 0; i < courses; ++i)
+        {
+            originals.push_back(make_course(random, i));
+            originals.back().add_grades(make_grades(random, originals.back()));
+            reports.emplace_back();
+            originals.back().render(reports.back());
+        }
+
+        std::vector<hyx::Course> forks;
+        std::vector<double> expected;
+
+        for (std::size_t i = 0; i < 4 * courses; ++i)
+        {
+            forks.push_back(originals[i % courses]);
+
+            if (i % 3 == 0)
+            {
+                forks.back().add_grade(hyx::Category_id(0), 5.0, 10.0);
+            }
+
+            expected.push_back(forks.back().get_grade());
+        }
+
+        hyx::recompute_all(forks, 4);
+
+        for (std::size_t i = 0; i < forks.size(); ++i)
+        {
+            check(same(expected[i], forks[i].get_grade()), "fork seed=" + std::to_string(seed) + " fork=" + std::to_string(i));
+        }
+
+        for (std::size_t i = 0; i < courses; ++i)
+        {
+            std::string report;
+
+            originals[i].render(report);
+            check(report == reports[i], "fork seed=" + std::to_string(seed) + " original=" + std::to_string(i) + " changed");
+        }
+    }
+
+    // only the numbers of a document, as integers or doubles.
+    class Number_handler
+        : public hyx::json::Handler
+    {
+    public:
+
+        std::vector<long long> integers;
+        std::vector<double> numbers;
+
+        bool null() override { return true; }
+
+        bool boolean(bool) override { return true; }
+
+        bool number(double value) override { this->numbers.push_back(value); return true; }
+
+        bool integer(long long value) override { this->integers.push_back(value); return true; }
+
+        bool string(std::string_view) override { return true; }
+
+        bool key(std::string_view) override { return true; }
+
+        bool start_object() override { return true; }
+
+        bool end_object() override { return true; }
+
+        bool start_array() override { return true; }
+
+        bool end_array() override { return true; }
+    };
+
+    // what the parser takes and refuses, and courses written, read and written again come back the same.
+    void check_json(std::uint64_t seed, std::size_t courses)
+    {
+        for (const char* text : { "01", "-01", "00", "1.", ".5", "+1", "-", "1e", "1e+", "0x10", "1.5.2", "NaN", "Infinity", "1e999",
+            "\"\\uDC00\"", "\"\\uDFFFx\"", "\"\\uD800\"", "\"\\uD800\\u0041\"" })
+        {
+            Number_handler handler;
+
+            check(not hyx::json::parse(text, handler), std::string("json accepted ") + text);
+        }
+
+        Number_handler handler;
+
+        check(hyx::json::parse("[0, -0, 10, -7, 9223372036854775807, 9223372036854775808, 0.5, 1e5, 1E+5, -1.5e-3, \"\\uD83D\\uDE00\"]", handler)
+            && handler.integers == std::vector<long long>{ 0, 0, 10, -7, 9223372036854775807 }
+            && handler.numbers == std::vector<double>{ 9223372036854775808.0, 0.5, 1e5, 1e5, -1.5e-3 }, "json numbers");
+
+        // JSON has no NaN or infinity, so neither the number nor a course holding one is written.
+        for (double value : { std::nan(""), std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity() })
+        {
+            std::string out;
+
+            check(not hyx::json::append_number(out, value) && out == "null", "json wrote " + out + " for " + std::to_string(value));
+
+            hyx::Course course("Not finite", 1, 3, hyx::scale::shared::STD(), "", "", "", "", {}, { 2021, 8, 23 }, { 2021, 12, 17 });
+            hyx::Course extra = course;
+
+            course.add_category("homework", 1.0);
+            course.add_grade("homework", value, 10.0);
+            extra.add_category("homework", 1.0);
+            extra.add_extra_to_total(value);
+            out = "before";
+
+            check(not hyx::Course_json::write(out, { &course }) && out == "before", "json wrote a score of " + std::to_string(value));
+            check(not hyx::Course_json::write(out, { &extra }) && out == "before", "json wrote extra credit of " + std::to_string(value));
+        }
+
+        Random random(seed);
+        std::vector<std::unique_ptr<hyx::Course>> written;
+
+        for (std::size_t i = 0; i < courses; ++i)
+        {
+            written.push_back(std::make_unique<hyx::Course>(make_course(random, i)));
+            written.back()->add_grades(make_grades(random, *written.back()));
+
+            if (i % 7 == 0)
+            {
+                written.back()->add_book("Book \"" + std::to_string(i) + "\"\t\\ \xC3\xA9 \xF0\x9F\x98\x80");
+            }
+
+            if (i % 11 == 0)
+            {
+                written.back()->add_extra_to_total(2.5);
+            }
+
+            if (i % 13 == 0)
+            {
+                written.back()->set_incomplete();
+            }
+        }
+
+        // a crn past 2^53, which a double would round.
+        written.push_back(std::make_unique<hyx::CourseWLAB>("Lab \x01 Course", 9007199254740993L, 4, hyx::scale::shared::U12(), "School", "Room 1", "Lab 2",
+            "Teacher", "details", std::array<bool, 8>{ false, false, true, false, true, false, false, true }, std::array<bool, 8>{ false, false, false, false, false, true, false, false },
+            std::array<int, 3>{ 2021, 8, 23 }, std::array<int, 3>{ 2021, 12, 17 }, std::array<int, 3>{ 2021, 8, 27 }, std::array<int, 3>{ 2021, 12, 10 },
+            std::array<int, 2>{ 9, 5 }, std::array<int, 2>{ 10, 20 }, std::array<int, 2>{ 13, 0 }, std::array<int, 2>{ 15, 50 }));
+        written.back()->add_category("labs", 1.0, 1);
+        written.back()->add_grade("labs", 9.5, 10.0);
+        written.back()->add_grade("labs", 0.1, 0.3);
+
+        std::vector<const hyx::Course*> pointers;
+
+        for (const auto& course : written)
+        {
+            pointers.push_back(course.get());
+        }
+
+        std::string first;
+        std::vector<std::unique_ptr<hyx::Course>> read;
+        hyx::json::Error error{ 0, nullptr };
+
+        check(hyx::Course_json::write(first, pointers), "json write");
+
+        if (not hyx::Course_json::read(first, read, &error))
+        {
+            check(false, std::string("json round trip did not read back: ") + error.reason + " at " + std::to_string(error.offset));
+
+            return;
+        }
+
+        check(read.size() == written.size(), "json round trip count");
+
+        std::vector<const hyx::Course*> read_pointers;
+
+        for (std::size_t i = 0; i < read.size() && i < written.size(); ++i)
+        {
+            std::string expected;
+            std::string actual;
+
+            written[i]->render(expected);
+            read[i]->render(actual);
+            read_pointers.push_back(read[i].get());
+
+            check(expected == actual, "json round trip course=" + std::to_string(i) + " renders differently");
+            check(written[i]->get_crn() == read[i]->get_crn(), "json round trip course=" + std::to_string(i) + " crn");
+            check(same(written[i]->get_grade(), read[i]->get_grade()), "json round trip course=" + std::to_string(i) + " grade");
+        }
+
+        std::string second;
+
+        hyx::Course_json::write(second, read_pointers);
+        check(first == second, "json round trip writes differently");
+    }
+
+    // the solved score earns the letter in what_if and a step less does not, on the linear and the bisection path alike.
+    void check_required_score(std::uint64_t seed, std::size_t courses)
+    {
+        Random random(seed);
+        std::size_t solved = 0;
+        std::size_t unreachable = 0;
+
+        for (std::size_t c = 0; c < courses; ++c)
+        {
+            Course_spec spec;
+            hyx::Course course = make_course(random, c, &spec);
+
+            course.add_grades(make_grades(random, course));
+
+            // planned grades land anywhere, so some are the first of a category another one replaces with.
+            std::vector<hyx::Course::Planned_grade> planned(1 + random.below(4));
+
+            for (auto& grade : planned)
+            {
+                grade = { hyx::Category_id(static_cast<std::uint32_t>(random.below(spec.categories.size()))), 10.0 * (1 + random.below(10)) };
+            }
+
+            auto grade_at = [&](double fraction) {
+                std::vector<hyx::Course::Grade_record> records;
+
+                for (const auto& grade : planned)
+                {
+                    records.push_back({ grade.category, fraction * grade.possible, grade.possible });
+                }
+
+                return course.what_if(records);
+            };
+            // whether a grade earns band or one above it.
+            auto earns = [&](double grade, std::size_t band) {
+                std::uint8_t found = (spec.point_based) ? spec.scale->find(grade, spec.base_points) : spec.scale->find(grade);
+
+                return found != hyx::Compiled_scale::npos && found <= band;
+            };
+
+            for (std::size_t band = 0; band < spec.scale->size(); ++band)
+            {
+                const std::string& letter = spec.scale->get_letter(static_cast<std::uint8_t>(band));
+                hyx::Course::Required_score required = course.required_score(letter, planned);
+                std::string what = "required_score course " + std::to_string(c) + " " + letter;
+
+                if (required.reachable)
+                {
+                    ++solved;
+                    check(required.fraction >= 0.0 && required.fraction <= 1.0 && same(required.grade, grade_at(required.fraction))
+                        && earns(required.grade, band), what + " not earned at " + std::to_string(required.fraction));
+                    check(required.fraction == 0.0 || not earns(grade_at(required.fraction - hyx::Course::Required_score::step), band),
+                        what + " earned a step below " + std::to_string(required.fraction));
+
+                    // nor anywhere lower, though drops can make the grade fall as the score rises.
+                    for (std::size_t probe = 0; probe < 8 && required.fraction != 0.0; ++probe)
+                    {
+                        double below = std::floor(random.uniform() * required.fraction / hyx::Course::Required_score::step) * hyx::Course::Required_score::step;
+
+                        check(not earns(grade_at(below), band), what + " earned at " + std::to_string(below) + " below " + std::to_string(required.fraction));
+                    }
+                }
+                else if (course.what_if({}) != -1)
+                {
+                    ++unreachable;
+                    check(required.fraction == 1.0 && same(required.grade, grade_at(1.0)) && not earns(required.grade, band), what + " reachable");
+                }
+            }
+
+            check(not course.required_score("no such letter", planned).reachable, "required_score of a letter not on the scale");
+        }
+
+        check(solved != 0 && unreachable != 0, "required_score reached both outcomes");
+    }
+
+    bool same_projection(const hyx::Grade_projection& lhs, const hyx::Grade_projection& rhs)
+    {
+        return lhs.letters == rhs.letters && lhs.trials == rhs.trials && same(lhs.no_letter, rhs.no_letter) && same(lhs.mean_grade, rhs.mean_grade)
+            && std::equal(lhs.probability.begin(), lhs.probability.end(), rhs.probability.begin(), rhs.probability.end(), same);
+    }
+
+    // projections come out the same on any number of threads, a course with nothing left keeps its letter, and the linear
+    // path agrees with working every trial out in full.
+    void check_projections(std::uint64_t seed, std::size_t courses)
+    {
+        Random random(seed);
+        std::vector<hyx::Course> made;
+        std::vector<std::vector<hyx::Category_forecast>> forecasts;
+
+        for (std::size_t c = 0; c < courses; ++c)
+        {
+            Course_spec spec;
+
+            made.push_back(make_course(random, c, &spec));
+            made.back().add_grades(make_grades(random, made.back()));
+
+            std::vector<hyx::Category_forecast> forecast;
+
+            for (std::size_t f = random.below(4); f != 0; --f)
+            {
+                hyx::Category_id category(static_cast<std::uint32_t>(random.below(spec.categories.size())));
+
+                forecast.push_back(hyx::Grade_projector::fit(made.back(), category, random.below(4), 10.0 * (1 + random.below(10))));
+            }
+
+            forecasts.push_back(forecast);
+        }
+
+        std::vector<const hyx::Course*> pointers;
+
+        for (const hyx::Course& course : made)
+        {
+            pointers.push_back(&course);
+        }
+
+        // an odd count, so the last chunk of trials is a short one.
+        const std::size_t trials = 3000 + random.below(1000);
+
+        for (std::size_t c = 0; c < made.size(); ++c)
+        {
+            hyx::Grade_projection one = hyx::Grade_projector::project(made[c], forecasts[c], trials, 1, seed);
+            std::string what = "projection of course " + std::to_string(c);
+
+            check(same_projection(one, hyx::Grade_projector::project(made[c], forecasts[c], trials, 2, seed))
+                && same_projection(one, hyx::Grade_projector::project(made[c], forecasts[c], trials, 5, seed)), what + " depends on threads");
+
+            // nothing left to grade leaves the grade where it is.
+            hyx::Grade_projection done = hyx::Grade_projector::project(made[c], {}, 1500, 3, seed);
+            const std::string& letter = made[c].get_letter();
+
+            if (made[c].get_grade() == -1 || letter.empty())
+            {
+                continue;
+            }
+
+            std::size_t band = static_cast<std::size_t>(std::distance(done.letters.begin(), std::find(done.letters.begin(), done.letters.end(), letter)));
+
+            check(band < done.letters.size() && done.probability[band] == 1.0 && done.no_letter == 0.0
+                && std::abs(done.mean_grade - made[c].get_grade()) < 1e-9, what + " with nothing left");
+        }
+
+        std::vector<const hyx::Course*> reversed(pointers.rbegin(), pointers.rend());
+        std::vector<std::vector<hyx::Category_forecast>> reversed_forecasts(forecasts.rbegin(), forecasts.rend());
+        std::vector<hyx::Grade_projection> all = hyx::Grade_projector::project(pointers, forecasts, 2000, 1, seed);
+        std::vector<hyx::Grade_projection> threaded = hyx::Grade_projector::project(reversed, reversed_forecasts, 2000, 3, seed);
+        bool matches = all.size() == pointers.size() && threaded.size() == pointers.size();
+
+        for (std::size_t c = 0; c < all.size() && matches; ++c)
+        {
+            matches = same_projection(all[c], threaded[threaded.size() - 1 - c]);
+        }
+
+        check(matches, "projections of a list depend on threads or order");
+
+        // a category of no weight that would replace from a category with nothing in it yet forces every trial through
+        // project_grade, and changes no grade.
+        for (bool point_based : { false, true })
+        {
+            hyx::Course linear("Linear", 1, 3, hyx::scale::shared::STD(), "", "", "", "", {}, { 2021, 8, 23 }, { 2021, 12, 17 });
+
+            if (point_based)
+            {
+                linear.set_point_based(500.0);
+            }
+
+            hyx::Category_id homework = linear.add_category("homework", 0.4);
+            hyx::Category_id exams = linear.add_category("exams", 0.6);
+
+            linear.add_grades(std::vector<hyx::Course::Grade_record>{ { homework, 8.0, 10.0 }, { homework, 7.5, 10.0 }, { homework, 9.0, 10.0 } });
+
+            hyx::Course full = linear;
+
+            full.add_category("makeup", 0.0, 0, { 1, "exams" });
+
+            std::vector<hyx::Category_forecast> forecast{ { homework, 3, 10.0, 0.8, 0.1 }, { exams, 2, 100.0, 0.7, 0.15 } };
+            hyx::Grade_projection fast = hyx::Grade_projector::project(linear, forecast, 5000, 2, seed);
+            hyx::Grade_projection slow = hyx::Grade_projector::project(full, forecast, 5000, 2, seed);
+            std::string what = std::string("projection paths ") + (point_based ? "point based" : "weighted");
+
+            check(fast.letters == slow.letters && fast.probability == slow.probability && fast.no_letter == slow.no_letter
+                && std::abs(fast.mean_grade - slow.mean_grade) < 1e-9, what + " disagree");
+        }
+    }
+
+    // an ungraded 0/0 is dropped before a real score, in either order and on every path.
+    void check_ungraded_drop()
+    {
+        const double orders[2][2][2] = { { { 0.0, 0.0 }, { 8.0, 10.0 } }, { { 8.0, 10.0 }, { 0.0, 0.0 } } };
+
+        for (const auto& order : orders)
+        {
+            hyx::Course course("Drops", 1, 3, hyx::scale::shared::STD(), "", "", "", "", {}, { 2021, 8, 23 }, { 2021, 12, 17 });
+            hyx::Category_id id = course.add_category("homework", 1.0, 1);
+            hyx::Course batched = course;
+
+            course.add_grade(id, order[0][0], order[0][1]);
+            course.add_grade(id, order[1][0], order[1][1]);
+            batched.add_grades(std::vector<hyx::Course::Grade_record>{ { id, order[0][0], order[0][1] }, { id, order[1][0], order[1][1] } });
+
+            hyx::Course copy = course;
+
+            copy.recompute();
+
+            std::string what = "ungraded drop " + std::to_string(order[0][1]) + "," + std::to_string(order[1][1]);
+
+            check(course.get_grade() == 80.0 && course.get_letter() == "B", what + " add_grade " + std::to_string(course.get_grade()));
+            check(batched.get_grade() == 80.0, what + " add_grades " + std::to_string(batched.get_grade()));
+            check(copy.get_grade() == 80.0, what + " recompute " + std::to_string(copy.get_grade()));
+            check(course.what_if({ { id, 0.0, 0.0 } }) == 80.0, what + " what_if");
+        }
+    }
+
+    // every instruction set this machine runs gives the scalar kernels' bits, on every tail length the vector loops leave.
+    void check_kernels(std::uint64_t seed)
+    {
+        Random random(seed);
+        const hyx::kernel::Table* scalar = hyx::kernel::table("scalar");
+
+        check(scalar != nullptr && hyx::kernel::table(hyx::kernel::instruction_set()) != nullptr, "kernel tables");
+
+        for (std::size_t count : { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 15, 16, 17, 31, 33, 1000, 1001, 1002, 1003 })
+        {
+            std::vector<double> weight(count);
+            std::vector<double> earned(count);
+            std::vector<double> possible(count);
+
+            // without the 0/0 scores, which make any sum NaN and so hide the order it was added in.
+            std::vector<double> graded(count);
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                std::size_t kind = random.below(20);
+
+                weight[i] = random.uniform();
+                possible[i] = (kind == 0) ? 0.0 : 1.0 + 100.0 * random.uniform();
+                earned[i] = (kind <= 1) ? 0.0 : possible[i] * 1.2 * random.uniform();
+                graded[i] = (kind == 0) ? 1.0 : possible[i];
+            }
+
+            std::vector<double> expected(count);
+
+            scalar->divide(earned.data(), possible.data(), expected.data(), count);
+
+            double expected_sum = scalar->weighted_ratio_sum(weight.data(), earned.data(), graded.data(), count);
+
+            for (const char* name : { "scalar", "sse2", "avx2" })
+            {
+                const hyx::kernel::Table* kernels = hyx::kernel::table(name);
+                std::string what = std::string("kernel ") + name + " count=" + std::to_string(count);
+
+                if (kernels == nullptr)
+                {
+                    continue;
+                }
+
+                // one past the end, so a vector store that overruns shows up.
+                std::vector<double> out(count + 1, 7.0);
+
+                kernels->divide(earned.data(), possible.data(), out.data(), count);
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    check(same(out[i], expected[i]), what + " divide " + std::to_string(i));
+                }
+
+                check(out[count] == 7.0, what + " divide wrote past the end");
+                check(same(kernels->weighted_ratio_sum(weight.data(), earned.data(), graded.data(), count), expected_sum), what + " weighted_ratio_sum");
+            }
+
+            std::pair<double, double> sums = hyx::kernel::sum_pair(earned.data(), graded.data(), count);
+            double sum_earned = 0.0;
+            double sum_possible = 0.0;
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                sum_earned += earned[i];
+                sum_possible += graded[i];
+            }
+
+            check(same(sums.first, sum_earned) && same(sums.second, sum_possible), "kernel sum_pair count=" + std::to_string(count));
+        }
+    }
+
+    // a scale with more bands than a byte can index compiles to none and is refused by the readers,
+    // and equal scales hash and intern alike however their bands were given while the same cutoffs under other letters do not.
+    void check_scales()
+    {
+        hyx::Grade_scale full;
+        hyx::Grade_scale over;
+
+        for (int band = 0; band <= static_cast<int>(hyx::Compiled_scale::max_bands); ++band)
+        {
+            (band < static_cast<int>(hyx::Compiled_scale::max_bands) ? full : over).emplace("L" + std::to_string(band), std::pair<int, int>(band, band));
+        }
+
+        over.insert(full.begin(), full.end());
+
+        hyx::Compiled_scale largest(full);
+        hyx::Compiled_scale rejected(over);
+
+        check(largest.size() == hyx::Compiled_scale::max_bands && largest.find(0.5) == hyx::Compiled_scale::max_bands - 1 && largest.find(254.0) == 0
+            && largest.find(254.0, 100.0) == 0, "scale with the most bands");
+        check(rejected.size() == 0 && rejected.find(50.0) == hyx::Compiled_scale::npos && rejected.find(300.0) == hyx::Compiled_scale::npos
+            && rejected.find(50.0, 200.0) == hyx::Compiled_scale::npos && hyx::Shared_scale(over)->size() == 0, "scale with too many bands");
+
+        for (const auto* scale : { &full, &over })
+        {
+            std::string text = "{\"courses\": [{\"crn\": 1, \"scale\": {";
+
+            for (const auto& band : *scale)
+            {
+                text += "\"" + band.first + "\": [" + std::to_string(band.second.first) + ", " + std::to_string(band.second.second) + "], ";
+            }
+
+            text.resize(text.size() - 2);
+            text += "}}]}";
+
+            std::vector<std::unique_ptr<hyx::Course>> read;
+
+            check(hyx::Course_json::read(text, read) == (scale == &full), "json scale of " + std::to_string(scale->size()) + " bands");
+        }
+
+        hyx::Grade_scale forward({ { "A", { 90, INT_MAX } }, { "B", { 80, 89 } }, { "C", { 0, 79 } } });
+        hyx::Grade_scale swapped({ { "B", { 90, INT_MAX } }, { "A", { 80, 89 } }, { "C", { 0, 79 } } });
+        hyx::Grade_scale rehashed(forward.begin(), forward.end(), 64);
+
+        check(hyx::Compiled_scale(forward).hash() == hyx::Compiled_scale(rehashed).hash()
+            && hyx::Compiled_scale(forward).hash() != hyx::Compiled_scale(swapped).hash(), "scale hash");
+        check(hyx::Shared_scale(forward) == hyx::Shared_scale(rehashed) && hyx::Shared_scale(forward) == hyx::Shared_scale(hyx::Compiled_scale(forward))
+            && hyx::Shared_scale(forward) != hyx::Shared_scale(swapped), "interned scales");
+    }
+
+    // the letter of a grade found the slow way: the band that holds the whole grade below it, highest first.
+    std::string scan_letter(const hyx::Grade_scale& scale, double grade, double base_points)
+    {
+        const hyx::Grade_scale::value_type* found = nullptr;
+        double floor_points = std::floor(grade) * base_points;
+
+        for (const auto& band : scale)
+        {
+            if (band.second.first * 100.0 <= floor_points && floor_points <= band.second.second * 100.0
+                && (found == nullptr || band.second.first > found->second.first))
+            {
+                found = &band;
+            }
+        }
+
+        return (found != nullptr) ? found->first : std::string();
+    }
+
+    // the percentage table and the per-band points give what scanning the scale does, for whole and fractional grades alike.
+    void check_scale_lookup(std::uint64_t seed)
+    {
+        Random random(seed);
+        std::vector<std::pair<hyx::Grade_scale, hyx::Compiled_scale>> scales = {
+            { hyx::scale::STD, hyx::Compiled_scale(hyx::scale::table::STD) },
+            { hyx::scale::G11, hyx::Compiled_scale(hyx::scale::table::G11) },
+            { hyx::scale::U12, hyx::Compiled_scale(hyx::scale::table::U12) },
+            { hyx::scale::U11, hyx::Compiled_scale(hyx::scale::table::U11) },
+            { hyx::scale::PF, hyx::Compiled_scale(hyx::scale::table::PF) } };
+        std::vector<std::string> letters;
+
+        for (const auto& itr : hyx::grade_points::STD)
+        {
+            letters.push_back(itr.first);
+        }
+
+        std::sort(letters.begin(), letters.end());
+
+        // random scales with gaps, some open at the top, with letters that carry points and some that do not.
+        for (std::size_t s = 0; s < 40; ++s)
+        {
+            hyx::Grade_scale scale;
+            int high = (random.below(2) == 0) ? INT_MAX : 100 - static_cast<int>(random.below(5));
+
+            for (std::size_t band = 0; high >= 0; ++band)
+            {
+                int low = std::max(0, high - static_cast<int>(random.below(15)));
+                std::string letter = (random.below(4) == 0) ? "X" + std::to_string(band) : letters[random.below(letters.size())];
+
+                scale.emplace(letter, std::pair<int, int>(low, high));
+                high = std::min(low, 100) - 1 - static_cast<int>(random.below(3));
+            }
+
+            scales.emplace_back(scale, hyx::Compiled_scale(scale));
+        }
+
+        std::vector<double> grades;
+
+        for (int perc = -3; perc <= 110; ++perc)
+        {
+            grades.insert(grades.end(), { double(perc), perc + random.uniform(), perc - 1e-9, perc + 0.5 });
+        }
+
+        for (const auto& entry : scales)
+        {
+            const hyx::Grade_scale& scale = entry.first;
+            const hyx::Compiled_scale& compiled = entry.second;
+
+            auto same_band = [&](std::uint8_t band, const std::string& letter) {
+                auto points = hyx::grade_points::STD.find(letter);
+
+                return (band == hyx::Compiled_scale::npos) ? letter.empty()
+                    : compiled.get_letter(band) == letter && compiled.get_points(band) == ((points != hyx::grade_points::STD.end()) ? points->second : -1.0);
+            };
+
+            check(hyx::Compiled_scale(scale) == compiled, "compiled table");
+
+            for (double grade : grades)
+            {
+                check(same_band(compiled.find(grade), scan_letter(scale, grade, 100.0)), "scale lookup of " + std::to_string(grade) + "%");
+                check(same_band(compiled.find(grade, 350.0), scan_letter(scale, grade, 350.0)), "scale lookup of " + std::to_string(grade) + " of 350 points");
+            }
+        }
+    }
+
+    // equal scales and points intern to one object, from any thread, and a change to the points of a letter on the scale makes another.
+    void check_scale_interning()
+    {
+        hyx::Scale_registry& registry = hyx::Scale_registry::instance();
+        hyx::Grade_points plus(hyx::grade_points::STD);
+        hyx::Grade_points unused(hyx::grade_points::STD);
+
+        plus["A"] = 4.3;
+        unused["E"] = 0.5;
+
+        hyx::Shared_scale standard = hyx::scale::shared::U12();
+        std::size_t size = registry.size();
+
+        check(hyx::Shared_scale(hyx::scale::U12) == standard && hyx::Shared_scale(hyx::scale::table::U12) == standard
+            && hyx::Shared_scale(hyx::Grade_scale(hyx::scale::U12.begin(), hyx::scale::U12.end(), 97), unused) == standard
+            && registry.size() == size, "standard scale interned once");
+
+        hyx::Shared_scale custom(hyx::scale::U12, plus);
+
+        check(custom != standard && hyx::Shared_scale(hyx::scale::U12, hyx::Grade_points(plus)) == custom
+            && hyx::Shared_scale(*custom) == custom && registry.size() == size + 1, "scale with its own points interned once");
+        check(custom->get_points(custom->find(95.0)) == 4.3 && standard->get_points(standard->find(95.0)) == 4.0, "interned points");
+
+        hyx::Grade_scale fresh({ { "H", { 85, INT_MAX } }, { "P", { 50, 84 } }, { "F", { 0, 49 } } });
+        std::vector<hyx::Shared_scale> shared(64, standard);
+
+        hyx::parallel_for(shared.size(), 4, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i)
+            {
+                shared[i] = hyx::Shared_scale(fresh);
+            }
+            });
+
+        check(std::all_of(shared.begin(), shared.end(), [&](const hyx::Shared_scale& scale) { return scale == shared[0] && scale != standard; })
+            && registry.size() == size + 2, "scale interned from many threads");
+    }
+
+    // accumulators over shards, merged, give the GPA of one pass over every course, split across threads or not.
+    // course grade points are floats, so these sums are exact in a double whatever order they are added in.
+    void check_GPA_merge(std::uint64_t seed)
+    {
+        Random random(seed);
+        std::vector<hyx::Course> pool;
+
+        for (std::size_t c = 0; c < 300; ++c)
+        {
+            pool.push_back(make_course(random, c));
+            pool.back().add_grades(make_grades(random, pool.back()));
+
+            if (c % 7 == 1)
+            {
+                pool.back().set_withdrawn();
+            }
+            else if (c % 7 == 2)
+            {
+                pool.back().set_pass_fail();
+            }
+            else if (c % 7 == 3)
+            {
+                pool.back().set_incomplete();
+            }
+        }
+
+        std::vector<const hyx::Course*> courses(9000 + random.below(4000));
+        hyx::GPA_accumulator serial;
+
+        for (auto& course : courses)
+        {
+            course = &pool[random.below(pool.size())];
+            serial.add(course);
+        }
+
+        hyx::GPA_accumulator merged;
+
+        for (std::size_t first = 0; first < courses.size();)
+        {
+            std::size_t last = std::min(courses.size(), first + random.below(3000));
+
+            merged.merge(hyx::accumulate_GPA(std::vector<const hyx::Course*>(courses.begin() + first, courses.begin() + last)));
+            first = last;
+        }
+
+        std::list<const hyx::Course*> listed(courses.begin(), courses.end());
+        hyx::GPA_accumulator pooled;
+
+        for (const auto& course : pool)
+        {
+            pooled.add(course);
+        }
+
+        auto same_sums = [](const hyx::GPA_accumulator& lhs, const hyx::GPA_accumulator& rhs) {
+            return lhs.get_grade_points() == rhs.get_grade_points() && lhs.get_units() == rhs.get_units();
+        };
+
+        check(serial.get_units() > 0 && same_sums(merged, serial), "merged GPA accumulators");
+        check(same_sums(hyx::accumulate_GPA(courses, 3), serial) && same_sums(hyx::accumulate_GPA(courses, 0), serial)
+            && same_sums(hyx::accumulate_GPA(listed, 4), serial), "GPA accumulated on threads");
+        check(same_sums(hyx::accumulate_GPA(pool), pooled) && hyx::get_GPA(pool) == pooled.get_GPA(), "GPA of courses");
+    }
+
+    // a fork allocates no score storage until it writes, and then only for the category it writes to.
+    void check_fork_storage()
+    {
+        constexpr std::size_t scores = 1000;
+        constexpr std::size_t category_bytes = scores * 2 * sizeof(double);
+
+        hyx::Course course("Storage", 1, 3, hyx::scale::shared::STD(), "", "", "", "", {}, { 2021, 8, 23 }, { 2021, 12, 17 });
+        std::vector<hyx::Course::Grade_record> grades;
+
+        for (std::uint32_t c = 0; c < 5; ++c)
+        {
+            hyx::Category_id id = course.add_category("cat" + std::to_string(c), 0.2);
+
+            for (std::size_t i = 0; i < scores; ++i)
+            {
+                grades.push_back({ id, static_cast<double>(i % 10), 10.0 });
+            }
+        }
+
+        course.add_grades(grades);
+
+        std::size_t before = allocated_bytes.load();
+        hyx::Course fork = course;
+        std::size_t fork_bytes = allocated_bytes.load() - before;
+
+        check(fork_bytes < category_bytes, "fork allocated " + std::to_string(fork_bytes) + " bytes");
+
+        before = allocated_bytes.load();
+        fork.add_grade(hyx::Category_id(2), 10.0, 10.0);
+
+        std::size_t write_bytes = allocated_bytes.load() - before;
+
+        // the written category, copied and grown to twice its size since it was full, and nothing of the other four.
+        check(write_bytes >= category_bytes && write_bytes < 3 * category_bytes, "fork write allocated " + std::to_string(write_bytes) + " bytes");
+
+        before = allocated_bytes.load();
+        fork.add_grade(hyx::Category_id(2), 10.0, 10.0);
+        write_bytes = allocated_bytes.load() - before;
+
+        check(write_bytes == 0, "second fork write allocated " + std::to_string(write_bytes) + " bytes");
+        check(course.get_grade() != fork.get_grade(), "fork write reached the original");
+    }
+
+    // built with -DHYX_STATS, only grades a course stores count as drops and replacements; what_if works grades out and stores none.
+    void check_stats()
+    {
+        if (not hyx::stats::enabled())
+        {
+            return;
+        }
+
+        hyx::Course course("Stats", 1, 3, hyx::scale::shared::STD(), "", "", "", "", {}, { 2021, 8, 23 }, { 2021, 12, 17 });
+        hyx::Category_id quizzes = course.add_category("quizzes", 0.5, 1, { 1, "FINAL" });
+        hyx::Category_id final = course.add_category("final", 0.5);
+
+        course.add_grade(final, 9.0, 10.0);
+        course.add_grade(quizzes, 2.0, 10.0);
+        course.add_grade(quizzes, 5.0, 10.0);
+        course.add_grade(quizzes, 8.0, 10.0);
+
+        hyx::stats::Totals before = hyx::stats::this_thread();
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            static_cast<void>(course.what_if({ { quizzes, 1.0, 10.0 } }));
+        }
+
+        hyx::stats::Totals after = hyx::stats::this_thread();
+
+        check(before.events[static_cast<std::size_t>(hyx::stats::Counter::drops)] != 0, "stats drops counted");
+        check(after.events[static_cast<std::size_t>(hyx::stats::Counter::drops)] == before.events[static_cast<std::size_t>(hyx::stats::Counter::drops)]
+            && after.events[static_cast<std::size_t>(hyx::stats::Counter::replacements)] == before.events[static_cast<std::size_t>(hyx::stats::Counter::replacements)],
+            "stats counted what_if");
+    }
+
+    // headers, scores that are not numbers and rows for withdrawn courses.
+    void check_csv()
+    {
+        hyx::Course open("Open", 101, 3, hyx::scale::shared::STD(), "", "", "", "", {}, { 2021, 8, 23 }, { 2021, 12, 17 });
+        hyx::Course withdrawn("Withdrawn", 102, 3, hyx::scale::shared::STD(), "", "", "", "", {}, { 2021, 8, 23 }, { 2021, 12, 17 });
+
+        open.add_category("homework", 1.0);
+        withdrawn.add_category("homework", 1.0);
+        withdrawn.set_withdrawn();
+
+        std::vector<hyx::Course*> courses{ &open, &withdrawn };
+
+        hyx::Import_summary header = hyx::Csv_importer(courses).import_text("Course_CRN, category, earned, possible\r\n101,homework,8,10\n");
+
+        check(header.rows == 1 && header.imported == 1 && header.malformed == 0, "csv header");
+
+        hyx::Import_summary not_header = hyx::Csv_importer(courses).import_text("crn,category,earned,possible\n101,homework,8,10\n");
+
+        check(not_header.rows == 2 && not_header.imported == 1 && not_header.malformed == 1
+            && not not_header.errors.empty() && not_header.errors[0].line == 1, "csv first line that is not the header");
+
+        hyx::Import_summary scores = hyx::Csv_importer(courses).import_text("101,homework,nan,10\n101,homework,8,inf\n101,homework,-INF,10\n");
+
+        check(scores.rows == 3 && scores.imported == 0 && scores.malformed == 3, "csv scores that are not finite");
+
+        open.add_category("say \"hi\", twice", 0.0);
+
+        hyx::Import_summary quoted = hyx::Csv_importer(courses).import_text("101,\"say \"\"hi\"\", twice\" ,8,10\n101,\"homework\"junk,8,10\n"
+            "101,\"homework\" x,8,10\n101,\"home\"\"work,8,10\n101,\"homework\"\r\n");
+
+        check(quoted.rows == 5 && quoted.imported == 1 && quoted.malformed == 4 && quoted.errors.size() == 4
+            && std::strcmp(quoted.errors[0].reason, "text after quote") == 0 && std::strcmp(quoted.errors[2].reason, "unterminated quote") == 0
+            && std::strcmp(quoted.errors[3].reason, "expected 4 fields") == 0, "csv quoted fields");
+
+        hyx::Import_summary signs = hyx::Csv_importer(courses).import_text("101,homework,+-5,10\n101,homework,+5,+10\n101,homework,+.5,10\n"
+            "101,homework,5,++10\n101,homework,+,10\n101,homework,-5,10\n");
+
+        check(signs.rows == 6 && signs.imported == 3 && signs.malformed == 3, "csv signs");
+
+        hyx::Import_summary skipped = hyx::Csv_importer(courses).import_text("102,homework,8,10\n102,homework,9,10\n101,homework,7,10\n");
+
+        check(skipped.rows == 3 && skipped.imported == 1 && skipped.skipped == 2 && skipped.malformed == 0
+            && skipped.errors.size() == 2 && skipped.errors[0].line == 1, "csv rows for a withdrawn course");
+    }
+
+    // the weekdays of the days in [first, last], a day at a time.
+    std::uint8_t weekdays_between(std::int64_t first, std::int64_t last)
+    {
+        std::uint8_t days = 0;
+
+        for (std::int64_t day = first; day <= last && day < first + 7; ++day)
+        {
+            // 1970-01-01 was a thursday.
+            days |= static_cast<std::uint8_t>(1 << ((day + 4) % 7 + 7) % 7);
+        }
+
+        return days;
+    }
+
+    // the weekdays two meetings clash on, found a day at a time; 0 if they never meet at the same time.
+    std::uint8_t clash(const hyx::Schedule& lhs, const hyx::Schedule& rhs)
+    {
+        auto timed = [](const hyx::Schedule& schedule) {
+            return schedule.start_minute != hyx::Schedule::no_time && schedule.end_minute != hyx::Schedule::no_time
+                && schedule.start_minute < schedule.end_minute;
+        };
+        auto last_day = [](const hyx::Schedule& schedule) {
+            return (schedule.end_day == hyx::Schedule::no_date) ? std::numeric_limits<std::int64_t>::max() : std::int64_t{ schedule.end_day };
+        };
+
+        if (not timed(lhs) || not timed(rhs) || lhs.start_minute >= rhs.end_minute || rhs.start_minute >= lhs.end_minute)
+        {
+            return 0;
+        }
+
+        // a missing start date is INT32_MIN, so it is already open.
+        return weekdays_between(std::max(lhs.start_day, rhs.start_day), std::min(last_day(lhs), last_day(rhs))) & lhs.week_days & rhs.week_days & 0x7F;
+    }
+
+    // a course that meets on random weekdays, dates and times of a few weeks, some open ended and some with a lab, in one of a
+    // few rooms with one of a few instructors.
+    std::unique_ptr<hyx::Course> make_meeting_course(Random& random, std::size_t index)
+    {
+        static const std::int32_t term = hyx::schedule::days_from_civil(2021, 9, 1);
+
+        auto week_days = [&]() {
+            std::array<bool, 8> days{};
+
+            for (bool& day : days)
+            {
+                day = random.below(3) == 0;
+            }
+
+            return days;
+        };
+        // short runs often miss a weekday the other meeting has, open ends never do.
+        auto dates = [&](std::array<int, 3>& start, std::array<int, 3>& end) {
+            std::int32_t first = term + static_cast<std::int32_t>(random.below(30));
+
+            start = (random.below(16) == 0) ? std::array<int, 3>{ 0, 0, 0 } : hyx::schedule::civil_from_days(first);
+            end = (random.below(8) == 0) ? std::array<int, 3>{ 0, 0, 0 }
+                : hyx::schedule::civil_from_days(first + static_cast<std::int32_t>((random.below(4) == 0) ? 100 : random.below(10)) - 1);
+        };
+        auto times = [&](std::array<int, 2>& start, std::array<int, 2>& end) {
+            int first = 8 * 60 + 10 * static_cast<int>(random.below(24));
+            int last = first + 10 * static_cast<int>(random.below(12));
+
+            start = (random.below(16) == 0) ? std::array<int, 2>{ -1, -1 } : std::array<int, 2>{ first / 60, first % 60 };
+            end = { last / 60, last % 60 };
+        };
+
+        std::string name = "Meeting " + std::to_string(index);
+        std::string room = "Room " + std::to_string(random.below(4));
+        std::string instructor = "Instructor " + std::to_string(random.below(3));
+        std::array<int, 3> start_date{};
+        std::array<int, 3> end_date{};
+        std::array<int, 2> start_time{};
+        std::array<int, 2> end_time{};
+
+        dates(start_date, end_date);
+        times(start_time, end_time);
+
+        if (random.below(3) != 0)
+        {
+            return std::make_unique<hyx::Course>(name, static_cast<long>(index), 3, hyx::scale::shared::STD(), "", room, instructor, "", week_days(),
+                start_date, end_date, start_time, end_time);
+        }
+
+        std::array<int, 3> lab_start_date{};
+        std::array<int, 3> lab_end_date{};
+        std::array<int, 2> lab_start_time{};
+        std::array<int, 2> lab_end_time{};
+
+        dates(lab_start_date, lab_end_date);
+        times(lab_start_time, lab_end_time);
+
+        return std::make_unique<hyx::CourseWLAB>(name, static_cast<long>(index), 4, hyx::scale::shared::STD(), "", room,
+            "Room " + std::to_string(random.below(4)), instructor, "", week_days(), week_days(),
+            start_date, end_date, lab_start_date, lab_end_date, start_time, end_time, lab_start_time, lab_end_time);
+    }
+
+    // the lecture, then the lab if there is one, as conflicts list them.
+    std::vector<std::pair<hyx::Schedule, bool>> meetings_of(const hyx::Course& course)
+    {
+        std::vector<std::pair<hyx::Schedule, bool>> meetings{ { course.get_schedule(), false } };
+
+        if (const hyx::CourseWLAB* lab = dynamic_cast<const hyx::CourseWLAB*>(&course))
+        {
+            meetings.push_back({ lab->get_lab_schedule(), true });
+        }
+
+        return meetings;
+    }
+
+    bool same_conflicts(const std::vector<hyx::Conflict>& lhs, const std::vector<hyx::Conflict>& rhs)
+    {
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](const hyx::Conflict& a, const hyx::Conflict& b) {
+            return a.first == b.first && a.first_lab == b.first_lab && a.second == b.second && a.second_lab == b.second_lab && a.week_days == b.week_days;
+            });
+    }
+
+    // the interval trees against every pair of meetings compared day by day.
+    void check_conflicts(std::uint64_t seed, std::size_t rounds)
+    {
+        Random random(seed);
+
+        for (std::size_t round = 0; round < rounds; ++round)
+        {
+            std::vector<std::unique_ptr<hyx::Course>> owned(random.below(80));
+            std::vector<const hyx::Course*> courses;
+
+            for (std::size_t c = 0; c < owned.size(); ++c)
+            {
+                owned[c] = make_meeting_course(random, c);
+                courses.push_back(owned[c].get());
+            }
+
+            // the first half is indexed and every course is proposed against it, including the indexed ones.
+            std::vector<const hyx::Course*> indexed(courses.begin(), courses.begin() + static_cast<std::ptrdiff_t>(courses.size() / 2));
+            hyx::Conflict_index all(courses);
+            hyx::Conflict_index half(indexed);
+            std::vector<hyx::Conflict> pairs;
+            std::vector<hyx::Conflict> proposed;
+
+            // built in the order conflicts are sorted in.
+            for (std::uint32_t i = 0; i < courses.size(); ++i)
+            {
+                for (const auto& lhs : meetings_of(*courses[i]))
+                {
+                    for (std::uint32_t j = 0; j < courses.size(); ++j)
+                    {
+                        for (const auto& rhs : meetings_of(*courses[j]))
+                        {
+                            std::uint8_t days = (i == j) ? 0 : clash(lhs.first, rhs.first);
+
+                            if (days != 0 && i < j)
+                            {
+                                pairs.push_back({ i, lhs.second, j, rhs.second, days });
+                            }
+
+                            if (days != 0 && j < indexed.size())
+                            {
+                                proposed.push_back({ i, lhs.second, j, rhs.second, days });
+                            }
+                        }
+                    }
+                }
+            }
+
+            std::string what = "conflicts round " + std::to_string(round);
+
+            check(same_conflicts(all.conflicts(), pairs), what + " conflicts");
+            check(same_conflicts(all.conflicts(3), pairs), what + " conflicts on 3 threads");
+            check(same_conflicts(half.check(courses), proposed), what + " check");
+
+            if (not courses.empty())
+            {
+                std::uint32_t one = static_cast<std::uint32_t>(random.below(courses.size()));
+                std::vector<hyx::Conflict> expected;
+
+                for (const hyx::Conflict& conflict : pairs)
+                {
+                    if (conflict.first == one || conflict.second == one)
+                    {
+                        bool first = conflict.first == one;
+
+                        expected.push_back({ 0, first ? conflict.first_lab : conflict.second_lab, first ? conflict.second : conflict.first,
+                            first ? conflict.second_lab : conflict.first_lab, conflict.week_days });
+                    }
+                }
+
+                std::sort(expected.begin(), expected.end(), [](const hyx::Conflict& lhs, const hyx::Conflict& rhs) {
+                    return std::tie(lhs.first_lab, lhs.second, lhs.second_lab) < std::tie(rhs.first_lab, rhs.second, rhs.second_lab);
+                    });
+
+                check(same_conflicts(all.check(*courses[one]), expected), what + " check one course");
+            }
+        }
+    }
+
+    // packed dates against a calendar counted one day at a time across leap years and days before 1970, and packed times against the clock.
+    void check_calendar(std::uint64_t seed)
+    {
+        static constexpr int month_days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+        auto leap = [](int year) { return year % 4 == 0 && (year % 100 != 0 || year % 400 == 0); };
+
+        constexpr int first_year = -800;
+        std::int32_t day = 0;
+        std::size_t wrong = 0;
+
+        for (int year = first_year; year < 1970; ++year)
+        {
+            day -= 365 + leap(year);
+        }
+
+        for (int year = first_year; year <= 2800; ++year)
+        {
+            for (int month = 1; month <= 12; ++month)
+            {
+                for (int date = 1; date <= month_days[month - 1] + (month == 2 && leap(year)); ++date, ++day)
+                {
+                    std::array<int, 3> civil{ year, month, date };
+
+                    wrong += (hyx::schedule::days_from_civil(year, month, date) != day || hyx::schedule::civil_from_days(day) != civil
+                        || hyx::schedule::weekday(day) != ((day % 7 + 11) % 7));
+                }
+            }
+        }
+
+        check(wrong == 0, "calendar days, " + std::to_string(wrong) + " wrong");
+
+        for (auto [year, month, date, valid] : { std::array<int, 4>{ 2020, 2, 29, 1 }, { 2021, 2, 29, 0 }, { 1900, 2, 29, 0 }, { 2000, 2, 29, 1 },
+            { -4, 2, 29, 1 }, { -100, 2, 29, 0 }, { 2021, 4, 31, 0 }, { 2021, 0, 1, 0 }, { 2021, 13, 1, 0 }, { 2021, 1, 0, 0 }, { 2021, 1, 32, 0 },
+            { 1000000, 12, 31, 1 }, { -1000000, 1, 1, 1 }, { 1000001, 1, 1, 0 }, { -1000001, 12, 31, 0 } })
+        {
+            std::int32_t packed = hyx::schedule::days_from_civil(year, month, date);
+
+            check((packed != hyx::Schedule::no_date) == (valid == 1)
+                && (valid == 0 || hyx::schedule::civil_from_days(packed) == std::array<int, 3>{ year, month, date }),
+                "calendar day " + std::to_string(year) + "-" + std::to_string(month) + "-" + std::to_string(date));
+        }
+
+        check(hyx::schedule::days_from_civil(1969, 12, 31) == -1 && hyx::schedule::days_from_civil(2000, 3, 1) == 11017
+            && hyx::schedule::civil_from_days(hyx::Schedule::no_date) == std::array<int, 3>{ 0, 0, 0 }, "calendar anchors");
+
+        std::string dates;
+
+        hyx::schedule::append_ISO_date(dates, hyx::schedule::days_from_civil(1969, 12, 31));
+        hyx::schedule::append_ISO_date(dates, hyx::Schedule::no_date);
+        hyx::schedule::append_ISO_date(dates, hyx::schedule::days_from_civil(2024, 2, 29));
+        check(dates == "1969-12-312024-02-29", "ISO dates");
+
+        for (int hour = -2; hour <= 25; ++hour)
+        {
+            for (int minute = -2; minute <= 61; ++minute)
+            {
+                bool valid = hour >= 0 && hour < 24 && minute >= 0 && minute < 60;
+                std::uint16_t packed = hyx::schedule::pack_time(hour, minute);
+
+                check((valid) ? packed == hour * 60 + minute && hyx::schedule::unpack_time(packed) == std::array<int, 2>{ hour, minute } : packed == hyx::Schedule::no_time,
+                    "packed time " + std::to_string(hour) + ":" + std::to_string(minute));
+            }
+        }
+
+        std::string times;
+
+        for (auto [hour, minute] : { std::array<int, 2>{ 0, 5 }, { 9, 5 }, { 12, 0 }, { 23, 59 }, { 24, 0 } })
+        {
+            hyx::schedule::append_clock_time(times, hyx::schedule::pack_time(hour, minute));
+        }
+
+        check(times == "12:05 AM09:05 AM12:00 PM11:59 PM" && hyx::schedule::unpack_time(hyx::Schedule::no_time) == std::array<int, 2>{ -1, -1 }, "clock times");
+
+        Random random(seed);
+
+        for (std::size_t round = 0; round < 2000; ++round)
+        {
+            std::int32_t first = static_cast<std::int32_t>(random.below(40)) - 20;
+            std::int32_t last = first + static_cast<std::int32_t>(random.below(12)) - 2;
+            int weekday = static_cast<int>(random.below(7));
+            bool found = false;
+
+            for (std::int32_t d = first; d <= last; ++d)
+            {
+                found |= hyx::schedule::weekday(d) == weekday;
+            }
+
+            check(hyx::schedule::has_weekday(first, last, weekday) == found, "weekday between " + std::to_string(first) + " and " + std::to_string(last));
+        }
+
+        check(hyx::schedule::has_weekday(INT32_MIN, -5, 3) && hyx::schedule::has_weekday(5, INT32_MAX, 3), "weekday in open dates");
+    }
+
+    // slots against a plain array of minutes, through set and the bitwise operators.
+    void check_week_slots(std::uint64_t seed)
+    {
+        Random random(seed);
+
+        for (std::size_t round = 0; round < 200; ++round)
+        {
+            hyx::Week_slots slots[2];
+            std::vector<bool> taken[2];
+
+            for (std::size_t s = 0; s < 2; ++s)
+            {
+                taken[s].assign(7 * hyx::Week_slots::day_slots, false);
+
+                for (std::size_t meeting = random.below(6); meeting != 0; --meeting)
+                {
+                    int weekday = static_cast<int>(random.below(7));
+                    std::uint16_t start = static_cast<std::uint16_t>(random.below(24 * 60 + 1));
+                    std::uint16_t end = static_cast<std::uint16_t>(start + random.below(24 * 60 + 1 - start));
+
+                    slots[s].set(weekday, start, end);
+
+                    for (std::size_t slot = 0; slot < hyx::Week_slots::day_slots; ++slot)
+                    {
+                        std::size_t minute = slot * hyx::Week_slots::slot_minutes;
+
+                        if (start <= minute && minute < end)
+                        {
+                            taken[s][weekday * hyx::Week_slots::day_slots + slot] = true;
+                        }
+                    }
+                }
+            }
+
+            hyx::Week_slots both = slots[0];
+            hyx::Week_slots either = slots[0];
+            hyx::Week_slots neither = ~slots[0];
+
+            both &= slots[1];
+            either |= slots[1];
+            neither &= ~slots[1];
+
+            std::size_t count = 0;
+            bool matches = true;
+
+            for (std::size_t slot = 0; slot < taken[0].size(); ++slot)
+            {
+                count += taken[0][slot];
+                matches = matches && slots[0].test(slot) == taken[0][slot] && both.test(slot) == (taken[0][slot] && taken[1][slot])
+                    && either.test(slot) == (taken[0][slot] || taken[1][slot]) && neither.test(slot) == not (taken[0][slot] || taken[1][slot]);
+            }
+
+            check(matches && slots[0].count() == count && both.count() + neither.count() + either.count() == taken[0].size() + both.count(),
+                "week slots round " + std::to_string(round));
+        }
+
+        hyx::Week_slots touching = hyx::Week_slots::hours(0x2A, 9 * 60, 9 * 60 + 52);
+        hyx::Week_slots next = hyx::Week_slots::hours(0x2A, 9 * 60 + 53, 10 * 60 + 40);
+
+        touching &= next;
+        check(touching.count() == 0, "week slots of meetings that only touch");
+    }
+
+    // rooms and instructors against every meeting and pair of meetings, slot by slot.
+    void check_utilization(std::uint64_t seed, std::size_t rounds)
+    {
+        Random random(seed);
+        const std::int32_t term = hyx::schedule::days_from_civil(2021, 9, 1);
+
+        for (std::size_t round = 0; round < rounds; ++round)
+        {
+            std::vector<std::unique_ptr<hyx::Course>> owned(random.below(40));
+            std::vector<const hyx::Course*> courses;
+
+            for (std::size_t c = 0; c < owned.size(); ++c)
+            {
+                owned[c] = make_meeting_course(random, c);
+                courses.push_back(owned[c].get());
+            }
+
+            // the whole calendar, a single week, or a stretch of the term.
+            std::int32_t first_day = INT32_MIN;
+            std::int32_t last_day = INT32_MAX;
+
+            if (round % 3 != 0)
+            {
+                first_day = term + static_cast<std::int32_t>(random.below(40));
+                last_day = first_day + ((round % 3 == 1) ? 6 : static_cast<std::int32_t>(random.below(30)));
+            }
+
+            struct Booked
+            {
+                hyx::Resource_kind kind;
+                std::string name;
+                hyx::Schedule schedule;
+                std::int64_t first_day;
+                std::int64_t last_day;
+            };
+
+            std::vector<Booked> booked;
+
+            for (const hyx::Course* course : courses)
+            {
+                auto book = [&](hyx::Resource_kind kind, const std::string& name, const hyx::Schedule& schedule) {
+                    std::int64_t end = (schedule.end_day == hyx::Schedule::no_date) ? std::numeric_limits<std::int64_t>::max() : schedule.end_day;
+
+                    booked.push_back({ kind, name, schedule, std::max(first_day, schedule.start_day), std::min<std::int64_t>(last_day, end) });
+                };
+
+                book(hyx::Resource_kind::room, course->get_location(), course->get_schedule());
+                book(hyx::Resource_kind::instructor, course->get_instructor(), course->get_schedule());
+
+                if (const hyx::CourseWLAB* lab = dynamic_cast<const hyx::CourseWLAB*>(course))
+                {
+                    book(hyx::Resource_kind::room, lab->get_lab_location(), lab->get_lab_schedule());
+                }
+            }
+
+            hyx::Utilization utilization(courses, first_day, last_day);
+            std::string what = "utilization round " + std::to_string(round);
+            std::size_t found = 0;
+
+            for (std::size_t r = 0; r < utilization.size(); ++r)
+            {
+                check(utilization.find(utilization.get_kind(r), utilization.get_name(r)) == r, what + " find");
+            }
+
+            for (hyx::Resource_kind kind : { hyx::Resource_kind::room, hyx::Resource_kind::instructor })
+            {
+                for (std::size_t number = 0; number < 4; ++number)
+                {
+                    std::string name = ((kind == hyx::Resource_kind::room) ? "Room " : "Instructor ") + std::to_string(number);
+                    std::vector<std::uint8_t> on(7 * hyx::Week_slots::day_slots, 0);
+                    std::vector<bool> twice(on.size(), false);
+                    std::vector<std::pair<const Booked*, std::uint8_t>> meetings;
+
+                    for (const Booked& meeting : booked)
+                    {
+                        std::uint8_t days = weekdays_between(meeting.first_day, meeting.last_day) & meeting.schedule.week_days & 0x7F;
+
+                        if (meeting.kind == kind && meeting.name == name && meeting.schedule.start_minute != hyx::Schedule::no_time
+                            && meeting.schedule.end_minute != hyx::Schedule::no_time && meeting.schedule.start_minute < meeting.schedule.end_minute
+                            && days != 0)
+                        {
+                            meetings.push_back({ &meeting, days });
+                        }
+                    }
+
+                    for (std::size_t slot = 0; slot < on.size(); ++slot)
+                    {
+                        int weekday = static_cast<int>(slot / hyx::Week_slots::day_slots);
+                        std::size_t minute = slot % hyx::Week_slots::day_slots * hyx::Week_slots::slot_minutes;
+                        std::vector<const Booked*> here;
+
+                        for (const auto& meeting : meetings)
+                        {
+                            if (((meeting.second >> weekday) & 1) && meeting.first->schedule.start_minute <= minute && minute < meeting.first->schedule.end_minute)
+                            {
+                                here.push_back(meeting.first);
+                            }
+                        }
+
+                        on[slot] = not here.empty();
+
+                        for (std::size_t i = 0; i < here.size(); ++i)
+                        {
+                            for (std::size_t j = i + 1; j < here.size(); ++j)
+                            {
+                                std::uint8_t shared = weekdays_between(std::max(here[i]->first_day, here[j]->first_day), std::min(here[i]->last_day, here[j]->last_day));
+
+                                twice[slot] = twice[slot] || ((shared >> weekday) & 1);
+                            }
+                        }
+                    }
+
+                    std::size_t r = utilization.find(kind, name);
+
+                    if (meetings.empty())
+                    {
+                        check(r == hyx::Utilization::npos, what + " " + name + " booked");
+
+                        continue;
+                    }
+
+                    ++found;
+
+                    if (r == hyx::Utilization::npos)
+                    {
+                        check(false, what + " " + name + " not booked");
+
+                        continue;
+                    }
+
+                    bool matches = true;
+
+                    for (std::size_t slot = 0; slot < on.size(); ++slot)
+                    {
+                        matches = matches && utilization.get_occupied(r).test(slot) == (on[slot] != 0) && utilization.get_double_booked(r).test(slot) == twice[slot];
+                    }
+
+                    check(matches, what + " " + name + " slots");
+                    check(utilization.report(hyx::Week_slots::hours(0x7F, 0, 24 * 60))[r].meetings == meetings.size(), what + " " + name + " meetings");
+                }
+            }
+
+            check(found == utilization.size(), what + " resources");
+        }
+
+        // one room taught in the fall and again in the spring is not double booked, nor are meetings that only touch.
+        hyx::Course fall("Fall", 1, 3, hyx::scale::shared::STD(), "", "Hall 1", "Smith", "", { false, true, false, true, false, true, false, false },
+            { 2021, 8, 23 }, { 2021, 12, 17 }, { 9, 0 }, { 9, 52 });
+        hyx::Course spring("Spring", 2, 3, hyx::scale::shared::STD(), "", "Hall 1", "Smith", "", { false, true, false, true, false, true, false, false },
+            { 2022, 1, 10 }, { 2022, 5, 6 }, { 9, 0 }, { 9, 52 });
+        hyx::Course after("After", 3, 3, hyx::scale::shared::STD(), "", "Hall 1", "Smith", "", { false, true, false, true, false, true, false, false },
+            { 2021, 8, 23 }, { 2021, 12, 17 }, { 9, 53 }, { 10, 40 });
+        hyx::Course again("Again", 4, 3, hyx::scale::shared::STD(), "", "Hall 1", "Jones", "", { false, true, false, false, false, false, false, false },
+            { 2021, 12, 13 }, { 2022, 1, 14 }, { 9, 30 }, { 10, 0 });
+
+        hyx::Utilization terms({ &fall, &spring, &after });
+        std::size_t hall = terms.find(hyx::Resource_kind::room, "Hall 1");
+
+        check(hall != hyx::Utilization::npos && terms.get_double_booked(hall).count() == 0
+            && terms.get_double_booked(terms.find(hyx::Resource_kind::instructor, "Smith")).count() == 0, "utilization of separate terms");
+
+        hyx::Utilization overlap({ &fall, &spring, &after, &again });
+
+        hall = overlap.find(hyx::Resource_kind::room, "Hall 1");
+        check(hall != hyx::Utilization::npos && overlap.double_bookings(hall).size() == 1
+            && overlap.double_bookings(hall)[0].weekday == 1 && overlap.double_bookings(hall)[0].start_minute == 9 * 60 + 30
+            && overlap.double_bookings(hall)[0].end_minute == 10 * 60, "utilization of meetings in both terms");
+    }
+
+    std::string read_file(const std::string& path)
+    {
+        std::string bytes;
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+
+        if (file != nullptr)
+        {
+            char buffer[4096];
+            std::size_t read = 0;
+
+            while ((read = std::fread(buffer, 1, sizeof(buffer), file)) != 0)
+            {
+                bytes.append(buffer, read);
+            }
+
+            std::fclose(file);
+        }
+
+        return bytes;
+    }
+
+    void write_file(const std::string& path, const std::string& bytes)
+    {
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+
+        if (file != nullptr)
+        {
+            std::fwrite(bytes.data(), 1, bytes.size(), file);
+            std::fclose(file);
+        }
+    }
+
+    // the names left in a directory.
+    std::vector<std::string> list_directory(const std::string& path)
+    {
+        std::vector<std::string> names;
+
+        if (DIR* directory = ::opendir(path.c_str()))
+        {
+            while (const dirent* entry = ::readdir(directory))
+            {
+                if (std::strcmp(entry->d_name, ".") != 0 && std::strcmp(entry->d_name, "..") != 0)
+                {
+                    names.push_back(entry->d_name);
+                }
+            }
+
+            ::closedir(directory);
+        }
+
+        std::sort(names.begin(), names.end());
+
+        return names;
+    }
+
+    // saved courses read back the same, and a file that is cut short or points outside itself is never opened.
+    void check_snapshot(std::uint64_t seed)
+    {
+        char directory[] = "/tmp/hyx_test.XXXXXX";
+
+        if (::mkdtemp(directory) == nullptr)
+        {
+            check(false, "snapshot directory");
+
+            return;
+        }
+
+        std::string path = std::string(directory) + "/courses.hyx";
+        std::string copy = std::string(directory) + "/copy.hyx";
+        Random random(seed);
+        std::vector<std::unique_ptr<hyx::Course>> owned;
+        std::vector<const hyx::Course*> courses;
+
+        for (std::size_t c = 0; c < 40; ++c)
+        {
+            std::unique_ptr<hyx::Course> course = (c % 4 == 3) ? make_meeting_course(random, c) : std::make_unique<hyx::Course>(make_course(random, c));
+
+            if (c % 4 == 3)
+            {
+                course->add_category("cat0", 1.0, 1);
+            }
+
+            course->add_grades(make_grades(random, *course));
+
+            if (c % 10 == 1)
+            {
+                course->set_withdrawn();
+            }
+            else if (c % 10 == 2)
+            {
+                course->set_incomplete();
+            }
+
+            courses.push_back(course.get());
+            owned.push_back(std::move(course));
+        }
+
+        check(hyx::Snapshot::save(path, courses) && hyx::Snapshot::save(path, courses), "snapshot save");
+        check(list_directory(directory) == std::vector<std::string>{ "courses.hyx" }, "snapshot save left a temporary file");
+        check(not hyx::Snapshot::save(std::string(directory) + "/missing/courses.hyx", courses), "snapshot saved into a missing directory");
+
+        hyx::Snapshot snapshot;
+        std::vector<std::unique_ptr<hyx::Course>> restored;
+        std::vector<const hyx::Course*> restored_pointers;
+
+        check(snapshot.open(path) && snapshot.size() == courses.size(), "snapshot open");
+
+        for (std::size_t c = 0; c < snapshot.size(); ++c)
+        {
+            hyx::Course_view view = snapshot[c];
+
+            check(same(view.get_grade(), courses[c]->get_grade()) && view.get_letter() == courses[c]->get_letter()
+                && view.get_status() == courses[c]->get_status() && view.get_grade_points() == courses[c]->get_grade_points(),
+                "snapshot view of course " + std::to_string(c));
+
+            restored.push_back(view.has_lab() ? std::make_unique<hyx::CourseWLAB>(view.to_course_with_lab()) : std::make_unique<hyx::Course>(view.to_course()));
+            restored_pointers.push_back(restored.back().get());
+        }
+
+        std::string saved;
+        std::string read_back;
+
+        check(hyx::Course_json::write(saved, courses) && hyx::Course_json::write(read_back, restored_pointers) && saved == read_back, "snapshot round trip");
+
+        // every field validate() looks at, pointed one past what the file holds.
+        std::string bytes = read_file(path);
+        hyx::snapshot::File_header header{};
+        hyx::snapshot::Course_record course{};
+        std::size_t graded = 0;
+
+        std::memcpy(&header, bytes.data(), sizeof(header));
+
+        while (graded < header.course_count)
+        {
+            std::memcpy(&course, bytes.data() + header.courses + graded * sizeof(course), sizeof(course));
+
+            if (course.band != hyx::Compiled_scale::npos)
+            {
+                break;
+            }
+
+            ++graded;
+        }
+
+        hyx::snapshot::Scale_record scale{};
+
+        std::memcpy(&scale, bytes.data() + header.scales + course.scale * sizeof(scale), sizeof(scale));
+        check(graded < header.course_count && header.category_count != 0, "snapshot has a graded course and a category");
+
+        write_file(copy, bytes);
+        check(hyx::Snapshot().open(copy), "snapshot copy opens");
+
+        auto refused = [&](const std::string& what, std::size_t offset, auto value) {
+            std::string bad = bytes;
+
+            std::memcpy(&bad[offset], &value, sizeof(value));
+            write_file(copy, bad);
+            check(not hyx::Snapshot().open(copy), "snapshot opened with " + what);
+        };
+
+        std::size_t graded_at = header.courses + graded * sizeof(course);
+
+        refused("another magic", offsetof(hyx::snapshot::File_header, magic), 'h');
+        refused("another version", offsetof(hyx::snapshot::File_header, version), hyx::snapshot::version + 1);
+        refused("another byte order", offsetof(hyx::snapshot::File_header, byte_order), std::uint32_t{ 0x04030201 });
+        refused("courses out of line", offsetof(hyx::snapshot::File_header, courses), header.courses + 1);
+        refused("too many scores", offsetof(hyx::snapshot::File_header, score_count), header.score_count + header.pool_size);
+        refused("a band past the end", header.scales + offsetof(hyx::snapshot::Scale_record, first_band), header.band_count + 1);
+        refused("a letter past the pool", header.bands + offsetof(hyx::snapshot::Band_record, letter), header.pool_size + 1);
+        refused("scores past the end", header.categories + offsetof(hyx::snapshot::Category_record, first_score), header.score_count + 1);
+        refused("a name past the pool", graded_at + offsetof(hyx::snapshot::Course_record, name), header.pool_size + 1);
+        refused("a scale past the end", graded_at + offsetof(hyx::snapshot::Course_record, scale), static_cast<std::uint32_t>(header.scale_count));
+        refused("categories past the end", graded_at + offsetof(hyx::snapshot::Course_record, first_category), header.category_count + 1);
+        refused("books past the end", graded_at + offsetof(hyx::snapshot::Course_record, first_book), header.book_count + 1);
+        refused("a band past its scale", graded_at + offsetof(hyx::snapshot::Course_record, band), static_cast<std::uint8_t>(scale.band_count));
+        refused("an unknown status", graded_at + offsetof(hyx::snapshot::Course_record, status), static_cast<std::uint8_t>(hyx::Course_status::incomplete) + 1);
+
+        // the pool is last, so every shorter file is missing part of a section.
+        for (std::size_t size = 0; size < bytes.size(); size += (size < sizeof(header) + 64 || size + 64 > bytes.size()) ? 1 : 61)
+        {
+            write_file(copy, bytes.substr(0, size));
+
+            if (hyx::Snapshot().open(copy))
+            {
+                check(false, "snapshot opened cut to " + std::to_string(size) + " bytes");
+            }
+        }
+
+        snapshot.close();
+        std::remove(path.c_str());
+        std::remove(copy.c_str());
+        ::rmdir(directory);
+    }
+
+    // transcripts written on any number of threads, through any buffer size, are the bytes of rendering them one by one.
+    void check_transcripts(std::uint64_t seed)
+    {
+        Random random(seed);
+        std::vector<std::unique_ptr<hyx::Course>> owned;
+        std::vector<hyx::Transcript> transcripts(90);
+        std::string expected;
+
+        for (std::size_t c = 0; c < 30; ++c)
+        {
+            owned.push_back(std::make_unique<hyx::Course>(make_course(random, c)));
+            owned.back()->add_grades(make_grades(random, *owned.back()));
+        }
+
+        for (std::size_t t = 0; t < transcripts.size(); ++t)
+        {
+            transcripts[t].student = "Student " + std::to_string(t);
+
+            for (std::size_t c = random.below(6); c > 0; --c)
+            {
+                transcripts[t].courses.push_back(owned[random.below(owned.size())].get());
+            }
+
+            hyx::render_transcript(expected, transcripts[t]);
+        }
+
+        hyx::render_transcript(expected, transcripts[0]);
+
+        for (auto [threads, buffer_size] : { std::pair<unsigned int, std::size_t>{ 1, 1 << 20 }, { 3, 1 << 20 }, { 2, 700 }, { 5, 64 }, { 4, 1 } })
+        {
+            char path[] = "/tmp/hyx_test.XXXXXX";
+            int fd = ::mkstemp(path);
+
+            if (fd < 0)
+            {
+                check(false, "transcript file");
+
+                return;
+            }
+
+            {
+                hyx::Transcript_writer writer(fd, buffer_size, threads);
+
+                check(writer.write(transcripts) && writer.write(std::vector<hyx::Transcript>()) && writer.write(transcripts[0]) && writer.flush(),
+                    "transcript writer on " + std::to_string(threads) + " threads");
+            }
+
+            ::close(fd);
+            check(read_file(path) == expected, "transcripts on " + std::to_string(threads) + " threads through " + std::to_string(buffer_size) + " bytes");
+            std::remove(path);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::uint64_t seed = 1;
+    std::size_t courses = 2000;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strncmp(argv[i], "--seed=", 7) == 0)
+        {
+            seed = std::strtoull(argv[i] + 7, nullptr, 10);
+        }
+        else if (std::strncmp(argv[i], "--courses=", 10) == 0)
+        {
+            courses = std::strtoull(argv[i] + 10, nullptr, 10);
+        }
+        else
+        {
+            std::printf("usage: %s [--seed=N] [--courses=N]\n", argv[0]);
+
+            return 2;
+        }
+    }
+
+    check_kernels(seed);
+    check_scales();
+    check_scale_lookup(seed);
+    check_scale_interning();
+    check_incremental(seed, courses);
+    check_forks(seed, courses / 4);
+    check_fork_storage();
+    check_stats();
+    check_GPA_merge(seed);
+    check_ungraded_drop();
+    check_required_score(seed, courses / 4);
+    check_projections(seed, courses / 40);
+    check_json(seed, courses / 4);
+    check_csv();
+    check_conflicts(seed, 200);
+    check_calendar(seed);
+    check_week_slots(seed);
+    check_utilization(seed, 200);
+    check_snapshot(seed);
+    check_transcripts(seed);
+
+    std::printf("%s: %zu failure%s\n", (failures == 0) ? "ok" : "FAILED", failures, (failures == 1) ? "" : "s");
+
+    return (failures == 0) ? 0 : 1;
+}